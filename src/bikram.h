@@ -20,7 +20,41 @@
  #ifndef BIKRAM_H
  #define BIKRAM_H
  
+ #include <atomic>
  #include <cmath>
+ #include <cstddef>
+ #include <cstdint>
+ #include <thread>
+ #include "bikram_simd.h"
+ #include "bikram_stats.h"
+ 
+ #ifdef BIKRAM_GENERATED_TABLE
+ #include "bikram_table.h" // extended month table generated at build time (tools/generate_table.cpp)
+ #endif
+ 
+ // Total number of days in a month table whose rows end with the year length.
+ template <int N>
+ constexpr long bikramTableDays(const int (&data)[N][13]) {
+     long total = 0;
+     for (int i = 0; i < N; ++i) {
+         total += data[i][12];
+     }
+     return total;
+ }
+ 
+ // Plain calendar dates for the value-returning API
+ struct BsDate {
+     int year, month, day;
+ };
+ 
+ struct AdDate {
+     int year, month, day;
+ };
+ 
+ constexpr bool operator==(const BsDate& a, const BsDate& b) { return a.year == b.year && a.month == b.month && a.day == b.day; }
+ constexpr bool operator!=(const BsDate& a, const BsDate& b) { return !(a == b); }
+ constexpr bool operator==(const AdDate& a, const AdDate& b) { return a.year == b.year && a.month == b.month && a.day == b.day; }
+ constexpr bool operator!=(const AdDate& a, const AdDate& b) { return !(a == b); }
  
  class Bikram {
  private:
@@ -28,18 +62,25 @@
      int Month = -1;
      int Day = 0;
  
-     double YugaRotation_star = 1582237828;
-     double YugaRotation_sun = 4320000;
-     double YugaCivilDays = YugaRotation_star - YugaRotation_sun;
-     double PlanetApogee_sun = 77 + 17.0 / 60;
-     double PlanetCircumm_sun = 13 + 50.0 / 60;
+     // Model constants, shared by every conversion; an instance only holds its last result
+     static constexpr double YugaRotation_star = 1582237828;
+     static constexpr double YugaRotation_sun = 4320000;
+     static constexpr double YugaCivilDays = YugaRotation_star - YugaRotation_sun;
+     static constexpr double PlanetApogee_sun = 77 + 17.0 / 60;
+     static constexpr double PlanetCircumm_sun = 13 + 50.0 / 60;
      static constexpr double rad = 57.2957795; // 180 / pi
  
+ #ifdef BIKRAM_GENERATED_TABLE
+     // Precomputed Data for the configured range. The hand-verified 2000-2099 rows below are
+     // copied into it unchanged; the other years come from the astronomical engine.
+     static const int BS_START_YEAR = BIKRAM_TABLE_START_YEAR;
+     static constexpr const auto& NP_MONTHS_DATA = BIKRAM_TABLE_DATA;
+ #else
      // Precomputed Data (starting from 2000 BS)
      static const int BS_START_YEAR = 2000;
      static const int BS_END_YEAR = 2089; // Need adjustment depending how much data we have
  
-     inline static const int NP_MONTHS_DATA[][13] = {
+     static constexpr int NP_MONTHS_DATA[][13] = {
          {30,32,31,32,31,30,30,30,29,30,29,31,365}, // 2000
          {31,31,32,31,31,31,30,29,30,29,30,30,365}, // 2001
          {31,31,32,32,31,30,30,29,30,29,30,30,365}, // 2002
@@ -141,52 +182,323 @@
          {31,31,32,31,31,31,30,29,30,29,30,30,365}, // 2098
          {31,32,31,32,31,30,30,29,30,29,30,30,365}, // 2099
      };
-     static const int NP_DATA_YEAR_COUNT = sizeof(NP_MONTHS_DATA) / sizeof(NP_MONTHS_DATA[0]);
+ #endif
+     static constexpr int NP_DATA_YEAR_COUNT = sizeof(NP_MONTHS_DATA) / sizeof(NP_MONTHS_DATA[0]);
+     static constexpr long NP_DATA_DAY_COUNT = bikramTableDays(NP_MONTHS_DATA);
  
-     void getSauraMasaDay(long ahar, int* m, int* d) const;
-     int todaySauraMasaFirstP(long ahar) const;
-     double getTslong(long ahar) const;
-     double getJulianDate(int year, int month, int day) const;
-     void fromJulianDate(double julian_date, int& year, int& month, int& day) const;
+     // Prefix sums over NP_MONTHS_DATA, built at compile time. Offsets count days from
+     // 1 Baisakh BS_START_YEAR (TABLE_START_JDN). tableDate searches them, which keeps the
+     // index to 13 ints per table year.
+     struct TableIndex {
+         int yearStart[NP_DATA_YEAR_COUNT + 1];
+         int monthStart[NP_DATA_YEAR_COUNT][12];
+     };
+     static constexpr TableIndex buildTableIndex();
+     static const TableIndex TABLE_INDEX;
  
-     void fromGregorianAstronomical(int y, int m, int d);  // fallback
-     void toGregorianAstronomical(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay); // fallback
+     static constexpr BsDate tableDate(long tableDay);
+     static BsDate toBsFallback(long jdn);
+     static AdDate toAdFallback(BsDate bs);
+ 
+     static void getSauraMasaDay(long ahar, int* m, int* d);
+     static int todaySauraMasaFirstP(long ahar);
+     static long findSauraMasaStart(long ahar, int* masa);
+     static double getTslong(long ahar);
+     static double getTslongAt(double ahar);
+
+     // First day (ahar) of a BS year and of each of its months, from the astronomical model
+     struct YearStructure {
+         long startAhar;
+         int monthStart[13]; // day offsets from startAhar; [12] is the length of the year
+     };
+     static long astronomicalMonthStart(int bsYear, int bsMonth);
+     static YearStructure astronomicalYear(int bsYear);
+     static BsDate astronomicalDate(long jdn);
+
+     // Direct-mapped cache of astronomical years, shared by all instances and threads. Each slot
+     // is guarded by a spinlock rather than std::mutex so libbikram needs no C++ runtime.
+     struct YearCacheSlot {
+         std::atomic<bool> busy{false};
+         bool filled = false;
+         int year = 0;
+         YearStructure data{};
+     };
+     static constexpr int YEAR_CACHE_SIZE = 256;
+     static YearCacheSlot yearCache[YEAR_CACHE_SIZE];
+
+     static const long BS_EPOCH_JDN; // 1 Baisakh 2000 BS = 14 April 1943
+     static const long TABLE_START_JDN; // 1 Baisakh BS_START_YEAR
  
  public:
+     // The from* and add* members store their result for getYear(), getMonth() and getDay().
+     // Everything else keeps no state, so it is static and safe to call from any thread;
+     // toBs() and toAd() below are the value-returning forms of the two conversions.
      void fromGregorian(int y, int m, int d);
-     void toGregorian(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay);
+     static void toGregorian(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay);
+ 
+     // Astronomical fallbacks, used outside the table. Public so benchmarks and
+     // validation tools can compare them with the table directly.
+     void fromGregorianAstronomical(int y, int m, int d);
+     static void toGregorianAstronomical(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay);
      int getYear() const;
      int getMonth() const;
      int getDay() const;
-     int daysInMonth(int bsYear, int bsMonth);
+     static int daysInMonth(int bsYear, int bsMonth);
+
+     // BS date arithmetic. Inside the table dates resolve through its cumulative day offsets,
+     // so moving by decades costs the same as moving by a day. Results are read with getYear(),
+     // getMonth() and getDay(); arguments must be valid BS dates.
+     static long bsToJulianDay(int bsYear, int bsMonth, int bsDay);
+     void fromJulianDayBs(long jdn);
+     void addDays(int bsYear, int bsMonth, int bsDay, long days);
+     // Moves by calendar months, clamping the day to the length of the target month
+     void addMonths(int bsYear, int bsMonth, int bsDay, long months);
+     // Signed distance from the first date to the second: days, or whole months as addMonths counts them
+     static long daysBetween(int fromYear, int fromMonth, int fromDay, int toYear, int toMonth, int toDay);
+     static long monthsBetween(int fromYear, int fromMonth, int fromDay, int toYear, int toMonth, int toDay);
+
+     // BS years answered from the month table
+     static constexpr int getTableStartYear() { return BS_START_YEAR; }
+     static constexpr int getTableEndYear() { return BS_START_YEAR + NP_DATA_YEAR_COUNT - 1; }
+
+     // Stateless, value-returning conversions. Within the table years they are constant
+     // expressions, so converting a literal date costs nothing at run time:
+     //   constexpr BsDate fiscalYearStart = Bikram::toBs({2025, 7, 17}); // 2082-04-01
+     // Other dates fall back to the astronomical model at run time. Arguments must be valid dates.
+     static constexpr BsDate toBs(AdDate ad);
+     static constexpr AdDate toAd(BsDate bs);
+     static constexpr int daysInBsMonth(int bsYear, int bsMonth);
+     // BS date of a Julian Day Number: from the table when it covers the day, otherwise from the model
+     static constexpr BsDate bsDate(long jdn);
+
+     // Day (JDN) on which the sun enters the sign that begins a BS month, from the astronomical
+     // model, with the minute of that day in minute. The model's day starts at mean midnight at Ujjain.
+     static long sankranti(int bsYear, int bsMonth, int& minute);
+ 
+     // Offset between a Julian Day Number and the ahar (days since the Kali epoch) used by the astronomical model
+     static constexpr long AHAR_JDN_OFFSET = 588466;
+
+     // True solar longitude in degrees at ahar, which may carry a fraction of a day. The model
+     // uses tslongLibm, or tslongPolynomial when built with BIKRAM_DETERMINISTIC_TSLONG; both
+     // are public so nepdate-validate can check that they agree on every month boundary.
+     static double tslongLibm(double ahar);
+     static double tslongPolynomial(double ahar);
+     // Whether a day with these longitudes at its start and end begins a saura masa
+     static bool isSauraMasaFirst(double tslong_today, double tslong_tomorrow);
+
+     // Solar longitude (as getTslong) for count ahar values, using SIMD where available.
+     // Values near a 30 degree boundary are recomputed exactly, so month boundaries match getTslong.
+     static void getTslongBatch(const long* ahar, double* tslong, std::size_t count);
+     // Model constants as the bikram_simd kernels take them
+     static constexpr BikramTslongParams TSLONG_PARAMS = {YugaRotation_sun, YugaCivilDays, PlanetApogee_sun, PlanetCircumm_sun, rad};
+ 
+     // Integer Julian Day Number <-> proleptic Gregorian date
+     static constexpr long toJulianDay(int year, int month, int day);
+     static constexpr void fromJulianDay(long jdn, int& year, int& month, int& day);
+     static constexpr int gregorianDaysInMonth(int year, int month);
  };
  
- inline void Bikram::getSauraMasaDay(long ahar, int* m, int* d) const {
-     double tslong_tomorrow;
-     int month;
-     int day;
-     if (todaySauraMasaFirstP(ahar)) {
-         day = 1;
-         tslong_tomorrow = getTslong(ahar + 1);
-         month = static_cast<int>(tslong_tomorrow / 30) % 12;
-         month = (month + 12) % 12;
-     } else {
-         getSauraMasaDay(ahar - 1, &month, &day);
-         day += 1;
+ constexpr long Bikram::toJulianDay(int year, int month, int day) {
+     // Shift the year to start in March so the leap day is the last day of the year
+     long y = static_cast<long>(year) - (month <= 2);
+     long era = (y >= 0 ? y : y - 399) / 400;
+     long yoe = y - era * 400;
+     long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+     long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+     return era * 146097 + doe + 1721120;
+ }
+ 
+ constexpr void Bikram::fromJulianDay(long jdn, int& year, int& month, int& day) {
+     long z = jdn - 1721120;
+     long era = (z >= 0 ? z : z - 146096) / 146097;
+     long doe = z - era * 146097;
+     long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+     long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+     long mp = (5 * doy + 2) / 153;
+     day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+     month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+     year = static_cast<int>(yoe + era * 400 + (month <= 2));
+ }
+ 
+ constexpr int Bikram::gregorianDaysInMonth(int year, int month) {
+     if (month == 2) {
+         return ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0) ? 29 : 28;
+     }
+     return (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+ }
+ 
+ inline constexpr long Bikram::BS_EPOCH_JDN = Bikram::toJulianDay(1943, 4, 14);
+ #ifdef BIKRAM_GENERATED_TABLE
+ inline constexpr long Bikram::TABLE_START_JDN = BIKRAM_TABLE_START_JDN;
+ #else
+ inline constexpr long Bikram::TABLE_START_JDN = Bikram::BS_EPOCH_JDN;
+ #endif
+ 
+ constexpr Bikram::TableIndex Bikram::buildTableIndex() {
+     TableIndex index{};
+     int offset = 0;
+     for (int y = 0; y < NP_DATA_YEAR_COUNT; ++y) {
+         index.yearStart[y] = offset;
+         for (int m = 0; m < 12; ++m) {
+             index.monthStart[y][m] = offset;
+             offset += NP_MONTHS_DATA[y][m];
+         }
+     }
+     index.yearStart[NP_DATA_YEAR_COUNT] = offset;
+     return index;
+ }
+ 
+ inline constexpr Bikram::TableIndex Bikram::TABLE_INDEX = Bikram::buildTableIndex();
+ 
+ inline Bikram::YearCacheSlot Bikram::yearCache[Bikram::YEAR_CACHE_SIZE];
+
+ constexpr BsDate Bikram::tableDate(long tableDay) {
+     // Guess the year from the table's mean year length and the month from the longest month,
+     // then step to the last year and month starting on or before tableDay: at most a step or two
+     // In 64 bits: a 1-9999 table makes the product about 3.6e10, past a 32-bit long
+     int year = static_cast<int>(static_cast<std::int64_t>(tableDay) * NP_DATA_YEAR_COUNT / NP_DATA_DAY_COUNT);
+     while (TABLE_INDEX.yearStart[year] > tableDay) --year;
+     while (TABLE_INDEX.yearStart[year + 1] <= tableDay) ++year;
+     const int* months = TABLE_INDEX.monthStart[year];
+     int month = static_cast<int>((tableDay - months[0]) / 32);
+     while (month < 11 && months[month + 1] <= tableDay) ++month;
+     return {BS_START_YEAR + year, month + 1, static_cast<int>(tableDay - months[month]) + 1};
+ }
+ 
+ constexpr BsDate Bikram::bsDate(long jdn) {
+     long tableDay = jdn - TABLE_START_JDN;
+     if (tableDay >= 0 && tableDay < NP_DATA_DAY_COUNT) {
+         BIKRAM_COUNT_AT_RUNTIME(TABLE_HITS);
+         return tableDate(tableDay);
+     }
+     return toBsFallback(jdn);
+ }
+ 
+ constexpr BsDate Bikram::toBs(AdDate ad) {
+     return bsDate(toJulianDay(ad.year, ad.month, ad.day));
+ }
+ 
+ constexpr AdDate Bikram::toAd(BsDate bs) {
+     if (bs.year >= BS_START_YEAR && bs.year < BS_START_YEAR + NP_DATA_YEAR_COUNT) {
+         BIKRAM_COUNT_AT_RUNTIME(TABLE_HITS);
+         AdDate ad{};
+         fromJulianDay(TABLE_START_JDN + TABLE_INDEX.monthStart[bs.year - BS_START_YEAR][bs.month - 1] + (bs.day - 1),
+                       ad.year, ad.month, ad.day);
+         return ad;
      }
-     *m = month;
-     *d = day;
+     return toAdFallback(bs);
+ }
+ 
+ constexpr int Bikram::daysInBsMonth(int bsYear, int bsMonth) {
+     if (bsYear >= BS_START_YEAR && bsYear < BS_START_YEAR + NP_DATA_YEAR_COUNT) {
+         BIKRAM_COUNT_AT_RUNTIME(TABLE_HITS);
+         return NP_MONTHS_DATA[bsYear - BS_START_YEAR][bsMonth - 1];
+     }
+     return daysInMonth(bsYear, bsMonth);
+ }
+ 
+ inline BsDate Bikram::toBsFallback(long jdn) {
+     BIKRAM_COUNT(FALLBACKS);
+     BIKRAM_TIME_START();
+     BsDate date = astronomicalDate(jdn);
+     if (jdn < TABLE_START_JDN && date.year >= BS_START_YEAR) {
+         // The model can begin the table's first year a day before the table does. Those days
+         // end the previous Chaitra, as daysInMonth and toGregorian already count them.
+         YearStructure year = astronomicalYear(BS_START_YEAR - 1);
+         date = {BS_START_YEAR - 1, 12, static_cast<int>(jdn - AHAR_JDN_OFFSET - year.startAhar - year.monthStart[11]) + 1};
+     }
+     BIKRAM_TIME_STOP(FALLBACK_CONVERSION);
+     return date;
+ }
+ 
+ inline AdDate Bikram::toAdFallback(BsDate bs) {
+     BIKRAM_COUNT(FALLBACKS);
+     BIKRAM_TIME_START();
+     AdDate ad;
+     toGregorianAstronomical(bs.year, bs.month, bs.day, ad.year, ad.month, ad.day);
+     BIKRAM_TIME_STOP(FALLBACK_CONVERSION);
+     return ad;
  }
  
- inline int Bikram::todaySauraMasaFirstP(long ahar) const {
-     double tslong_today = getTslong(ahar);
-     double tslong_tomorrow = getTslong(ahar + 1);
+ inline void Bikram::getSauraMasaDay(long ahar, int* m, int* d) {
+     long start = findSauraMasaStart(ahar, m);
+     *d = static_cast<int>(ahar - start) + 1;
+ }
+ 
+ inline int Bikram::todaySauraMasaFirstP(long ahar) {
+     return isSauraMasaFirst(getTslong(ahar), getTslong(ahar + 1)) ? 1 : 0;
+ }
+ 
+ // A saura masa starts on the day during which the sun crosses a 30 degree boundary
+ inline bool Bikram::isSauraMasaFirst(double tslong_today, double tslong_tomorrow) {
      tslong_today -= static_cast<int>(tslong_today / 30) * 30;
      tslong_tomorrow -= static_cast<int>(tslong_tomorrow / 30) * 30;
-     return (25 < tslong_today && tslong_tomorrow < 5) ? 1 : 0;
+     return 25 < tslong_today && tslong_tomorrow < 5;
  }
  
- inline double Bikram::getTslong(long ahar) const {
+ // Find the first day of the saura masa containing ahar (the sankranti day) and its
+ // month number (0 = Baisakh). The boundary is estimated from how far the sun has
+ // moved into the current 30 degree segment, then bracketed and confirmed with the
+ // same day test the old day-by-day walk used, so results are identical to it.
+ inline long Bikram::findSauraMasaStart(long ahar, int* masa) {
+     double today = getTslong(ahar);
+     double tomorrow = getTslong(ahar + 1);
+     double motion = tomorrow - today;
+     if (motion <= 0) motion += 360; // mean longitude wrapped between the two days
+     double past = tomorrow - static_cast<int>(tomorrow / 30) * 30;
+     long guess = static_cast<long>(std::ceil((ahar + 1) - past / motion)) - 1;
+ 
+     // The estimate is within a day of the boundary; a +/-2 day bracket is ample.
+     const int window = 2;
+     long first = guess - window;
+     long last = guess + window < ahar ? guess + window : ahar;
+     long days[2 * window + 2] = {};
+     double tslong[2 * window + 2] = {};
+     std::size_t count = 0;
+     for (long a = first; a <= last + 1; ++a) {
+         days[count++] = a;
+     }
+     std::size_t steps = count;
+     getTslongBatch(days, tslong, count);
+     long start = first - 1;
+     double tslong_next = 0;
+     for (long a = last; a >= first; --a) {
+         if (isSauraMasaFirst(tslong[a - first], tslong[a - first + 1])) {
+             start = a;
+             tslong_next = tslong[a - first + 1];
+             break;
+         }
+     }
+     if (start < first) {
+         // Not bracketed: fall back to stepping back one day at a time
+         while (!todaySauraMasaFirstP(start)) {
+             --start;
+             ++steps;
+         }
+         tslong_next = getTslong(start + 1);
+     }
+     BIKRAM_COUNT(SOLVER_RUNS);
+     BIKRAM_COUNT_SOLVER_STEPS(steps);
+     int month = static_cast<int>(tslong_next / 30) % 12;
+     *masa = (month + 12) % 12;
+     return start;
+ }
+ 
+ inline double Bikram::getTslong(long ahar) {
+     BIKRAM_COUNT(TSLONG_EVALUATIONS);
+     return getTslongAt(static_cast<double>(ahar));
+ }
+
+ inline double Bikram::getTslongAt(double ahar) {
+ #ifdef BIKRAM_DETERMINISTIC_TSLONG
+     return tslongPolynomial(ahar);
+ #else
+     return tslongLibm(ahar);
+ #endif
+ }
+
+ // Mean longitude corrected by the equation of centre, with libm sin and asin
+ inline double Bikram::tslongLibm(double ahar) {
      double mslong;
      double t1 = (YugaRotation_sun * ahar / YugaCivilDays);
      t1 -= static_cast<long>(t1);
@@ -199,107 +511,186 @@
      double x3 = mslong - x2;
      return x3;
  }
- 
- inline double Bikram::getJulianDate(int year, int month, int day) const {
-     if (month <= 2) {
-         year -= 1;
-         month += 12;
+
+ // The same model with no libm calls, so every platform computes the same bits:
+ //   mean longitude  the fraction of a revolution comes from the exact integer remainder of
+ //                   YugaRotation_sun * day modulo YugaCivilDays, not from a ~5000-turn quotient
+ //   sin             reduced to [-pi/4, pi/4] with a two-part pi/2, then the fdlibm minimax
+ //                   polynomials for sin (degree 13) or cos (degree 14), each within 2^-58
+ //   asin            only sees |x| < 0.0385, where the series to x^11 is exact to 1e-20
+ // The result is within a few ulp of the exact model. It differs from tslongLibm by at most
+ // ~4e-10 degrees, the rounding of tslongLibm's mean-longitude quotient, which is far too
+ // little to move a month boundary; nepdate-validate checks every day of its range.
+ inline double Bikram::tslongPolynomial(double ahar) {
+     // YugaRotation_sun * day % YugaCivilDays. Every value is an integer below 2^53, so the double
+     // arithmetic is exact; the estimated quotient is off by at most one.
+     double day = static_cast<double>(static_cast<std::int64_t>(ahar));
+     if (day > ahar) day -= 1;
+     double product = YugaRotation_sun * day;
+     double estimate = product * (1 / YugaCivilDays);
+     double quotient = static_cast<double>(static_cast<std::int64_t>(estimate));
+     if (quotient > estimate) quotient -= 1;
+     double remainder = product - quotient * YugaCivilDays;
+     if (remainder < 0) {
+         remainder += YugaCivilDays;
+     } else if (remainder >= YugaCivilDays) {
+         remainder -= YugaCivilDays;
+     }
+     double turns = (remainder + YugaRotation_sun * (ahar - day)) * (1 / YugaCivilDays);
+     if (turns >= 1) turns -= 1;
+     if (ahar < 0 && turns > 0) turns -= 1; // tslongLibm truncates toward zero
+     double mslong = 360 * turns;
+
+     // sin((mslong - apogee) / rad), with x = r + k * pi/2
+     constexpr double twoOverPi = 0.636619772367581343076;
+     constexpr double halfPiHigh = 1.57079632673412561417;    // first 33 bits, so k * halfPiHigh is exact
+     constexpr double halfPiLow = 6.07710050650619224932e-11; // pi/2 - halfPiHigh
+     double x = (mslong - PlanetApogee_sun) * (1 / rad);
+     int k = static_cast<int>(x * twoOverPi + (x >= 0 ? 0.5 : -0.5));
+     double r = (x - k * halfPiHigh) - k * halfPiLow;
+     double z = r * r;
+     double sine;
+     if (k & 1) {
+         double c = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05
+                    + z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+         sine = 1 - (0.5 * z - z * c);
+     } else {
+         double s = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+                    + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+         sine = r + r * z * (-1.66666666666666324348e-01 + z * s);
      }
-     double a = floor(year / 100.0);
-     double b = 2 - a + floor(a / 4.0);
-     return floor(365.25 * (year + 4716)) + floor(30.6001 * (month + 1)) + day + b - 1524.5;
+     if (k & 2) sine = -sine;
+
+     double y = PlanetCircumm_sun / 360 * sine;
+     double y2 = y * y;
+     double arcsine = y + y * y2 * (1.0 / 6 + y2 * (3.0 / 40 + y2 * (5.0 / 112 + y2 * (35.0 / 1152 + y2 * (63.0 / 2816)))));
+     return mslong - arcsine * rad;
  }
- 
- inline void Bikram::fromJulianDate(double julian_date, int& year, int& month, int& day) const {
-     int a = static_cast<int>(julian_date + 0.5);
-     int b = a + 1537;
-     int c = static_cast<int>((b - 122.1) / 365.25);
-     int d = static_cast<int>(365.25 * c);
-     int e = static_cast<int>((b - d) / 30.6001);
-     double f = b - d - static_cast<int>(30.6001 * e) + (julian_date + 0.5 - a);
-     day = static_cast<int>(f);
-     month = (e < 14) ? (e - 1) : (e - 13);
-     year = (month > 2) ? (c - 4716) : (c - 4715);
+
+ inline void Bikram::getTslongBatch(const long* ahar, double* tslong, std::size_t count) {
+ #ifdef BIKRAM_HAVE_X86_SIMD
+     BIKRAM_COUNT_N(TSLONG_EVALUATIONS, count);
+     if (bikram_simd::hasAvx2()) {
+         bikram_simd::tslongAvx2(ahar, tslong, count, TSLONG_PARAMS);
+     } else {
+         bikram_simd::tslongSse2(ahar, tslong, count, TSLONG_PARAMS);
+     }
+     for (std::size_t i = 0; i < count; ++i) {
+         double past = tslong[i] - static_cast<int>(tslong[i] / 30) * 30;
+         if (past < TSLONG_BATCH_EPSILON || past > 30 - TSLONG_BATCH_EPSILON) {
+             tslong[i] = getTslong(ahar[i]);
+         }
+     }
+ #else
+     for (std::size_t i = 0; i < count; ++i) {
+         tslong[i] = getTslong(ahar[i]);
+     }
+ #endif
  }
  
+ 
  // ------------- Modified fromGregorian to use precomputed first --------------
  inline void Bikram::fromGregorian(int y, int m, int d) {
-     // First calculate Julian days from fixed known date
-     double julian = getJulianDate(y, m, d);
-     double ref_julian = getJulianDate(1943, 4, 14); // 1 Baisakh 2000 BS = 14 April 1943
- 
-     long diff = static_cast<long>(julian - ref_julian);
-     int bs_year = BS_START_YEAR;
- 
-     if (diff >= 0) {
-         while (bs_year <= BS_START_YEAR + NP_DATA_YEAR_COUNT - 1) {
-             for (int i = 0; i < 12; ++i) {
-                 if (diff < NP_MONTHS_DATA[bs_year - BS_START_YEAR][i]) {
-                     Year = bs_year;
-                     Month = i + 1;
-                     Day = static_cast<int>(diff) + 1;
-                     return;
-                 } else {
-                     diff -= NP_MONTHS_DATA[bs_year - BS_START_YEAR][i];
-                 }
-             }
-             bs_year++;
-         }
-     }
-     // fallback to astronomical if outside precomputed
-     fromGregorianAstronomical(y, m, d);
+     BsDate date = toBs({y, m, d});
+     Year = date.year;
+     Month = date.month;
+     Day = date.day;
  }
  
  // -------------  Use precomputed first --------------
  inline void Bikram::toGregorian(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay) {
      if (bsYear >= BS_START_YEAR && bsYear < BS_START_YEAR + NP_DATA_YEAR_COUNT) {
-         double ref_julian = getJulianDate(1943, 4, 14); // 1 Baisakh 2000 BS
-         long total_days = 0;
-         for (int year = BS_START_YEAR; year < bsYear; ++year) {
-             total_days += NP_MONTHS_DATA[year - BS_START_YEAR][12];
-         }
-         for (int month = 0; month < bsMonth - 1; ++month) {
-             total_days += NP_MONTHS_DATA[bsYear - BS_START_YEAR][month];
-         }
-         total_days += (bsDay - 1);
- 
-         double target_julian = ref_julian + total_days;
-         fromJulianDate(target_julian, gYear, gMonth, gDay);
+         BIKRAM_COUNT(TABLE_HITS);
+         long total_days = TABLE_INDEX.monthStart[bsYear - BS_START_YEAR][bsMonth - 1] + (bsDay - 1);
+         fromJulianDay(TABLE_START_JDN + total_days, gYear, gMonth, gDay);
          return;
      }
      // fallback to astronomical
+     BIKRAM_COUNT(FALLBACKS);
+     BIKRAM_TIME_START();
      toGregorianAstronomical(bsYear, bsMonth, bsDay, gYear, gMonth, gDay);
+     BIKRAM_TIME_STOP(FALLBACK_CONVERSION);
  }
  
  // fallback methods
  
- inline void Bikram::fromGregorianAstronomical(int y, int m, int d) {
-     double julian = getJulianDate(y, m, d);
-     long ahar = julian - 588465.5;
-     int saura_masa_num;
-     int saura_masa_day;
-     getSauraMasaDay(ahar, &saura_masa_num, &saura_masa_day);
-     long YearKali = static_cast<long>(ahar * YugaRotation_sun / YugaCivilDays);
-     int YearSaka = YearKali - 3179;
-     int nepalimonth = (saura_masa_num) % 12;
-     Year = YearSaka + 135 + static_cast<int>((saura_masa_num - nepalimonth) / 12);
-     Month = (saura_masa_num + 12) % 12 + 1;
-     Day = saura_masa_day;
- }
- 
- inline void Bikram::toGregorianAstronomical(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay) {
+ // First day (ahar) of a BS month, found with the sankranti solver
+ inline long Bikram::astronomicalMonthStart(int bsYear, int bsMonth) {
      int YearSaka = bsYear - 135;
      long YearKali = YearSaka + 3179;
      long ahar = static_cast<long>((YearKali * YugaCivilDays) / YugaRotation_sun);
-     int saura_masa_num, saura_masa_day;
-     getSauraMasaDay(ahar, &saura_masa_num, &saura_masa_day);
-     bsMonth = (bsMonth + 11) % 12;
-     while (saura_masa_num != bsMonth || saura_masa_day != bsDay) {
-         ahar += (saura_masa_num < bsMonth || (saura_masa_num == bsMonth && saura_masa_day < bsDay)) ? 1 : -1;
-         getSauraMasaDay(ahar, &saura_masa_num, &saura_masa_day);
+     // The true sankranti is within a few days of the mean one, so the middle of the
+     // mean month always lies inside the requested saura masa.
+     ahar += static_cast<long>((bsMonth - 1) * YugaCivilDays / YugaRotation_sun / 12) + 15;
+     int saura_masa_num;
+     return findSauraMasaStart(ahar, &saura_masa_num);
+ }
+ 
+ // Month structure of a BS year, from the cache or computed and stored there. The 13
+ // solver runs happen outside the slot lock, so a slow fill never blocks other years.
+ inline Bikram::YearStructure Bikram::astronomicalYear(int bsYear) {
+     YearCacheSlot& slot = yearCache[static_cast<unsigned>(bsYear) % YEAR_CACHE_SIZE];
+     auto lock = [&slot] {
+         while (slot.busy.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+     };
+ 
+     lock();
+     if (slot.filled && slot.year == bsYear) {
+         YearStructure cached = slot.data;
+         slot.busy.store(false, std::memory_order_release);
+         BIKRAM_COUNT(YEAR_CACHE_HITS);
+         return cached;
      }
-     double julian_date = ahar + 588465.5;
-     fromJulianDate(julian_date, gYear, gMonth, gDay);
+     slot.busy.store(false, std::memory_order_release);
+     BIKRAM_COUNT(YEAR_CACHE_MISSES);
+     BIKRAM_TIME_START();
+ 
+     YearStructure year;
+     year.startAhar = astronomicalMonthStart(bsYear, 1);
+     year.monthStart[0] = 0;
+     for (int month = 2; month <= 12; ++month) {
+         year.monthStart[month - 1] = static_cast<int>(astronomicalMonthStart(bsYear, month) - year.startAhar);
+     }
+     year.monthStart[12] = static_cast<int>(astronomicalMonthStart(bsYear + 1, 1) - year.startAhar);
+     BIKRAM_TIME_STOP(YEAR_COMPUTE);
+ 
+     lock();
+     slot.filled = true;
+     slot.year = bsYear;
+     slot.data = year;
+     slot.busy.store(false, std::memory_order_release);
+     return year;
+ }
+ 
+ // BS date of a day from the astronomical model alone
+ inline BsDate Bikram::astronomicalDate(long jdn) {
+     long ahar = jdn - AHAR_JDN_OFFSET;
+     // Start from the mean year; the true new year is within a few days of it
+     int bsYear = static_cast<int>(static_cast<long>(ahar * YugaRotation_sun / YugaCivilDays) - 3179 + 135);
+     YearStructure year = astronomicalYear(bsYear);
+     if (ahar < year.startAhar) {
+         year = astronomicalYear(--bsYear);
+     } else if (ahar >= year.startAhar + year.monthStart[12]) {
+         year = astronomicalYear(++bsYear);
+     }
+     int offset = static_cast<int>(ahar - year.startAhar);
+     int month = 1;
+     while (month < 12 && offset >= year.monthStart[month]) ++month;
+     return {bsYear, month, offset - year.monthStart[month - 1] + 1};
+ }
+ 
+ inline void Bikram::fromGregorianAstronomical(int y, int m, int d) {
+     BsDate date = astronomicalDate(toJulianDay(y, m, d));
+     Year = date.year;
+     Month = date.month;
+     Day = date.day;
+ }
+
+ 
+ inline void Bikram::toGregorianAstronomical(int bsYear, int bsMonth, int bsDay, int& gYear, int& gMonth, int& gDay) {
+     YearStructure year = astronomicalYear(bsYear);
+     long start = year.startAhar + year.monthStart[bsMonth - 1];
+     fromJulianDay(start + bsDay - 1 + AHAR_JDN_OFFSET, gYear, gMonth, gDay);
  }
  
  inline int Bikram::getYear() const {
@@ -316,17 +707,154 @@
  
  inline int Bikram::daysInMonth(int bsYear, int bsMonth) {
      if (bsYear >= BS_START_YEAR && bsYear < BS_START_YEAR + NP_DATA_YEAR_COUNT) {
+         BIKRAM_COUNT(TABLE_HITS);
          return NP_MONTHS_DATA[bsYear - BS_START_YEAR][bsMonth - 1];
      }
      // fallback method
-     int gYear, gMonth, gDay;
-     int nextMonth = (bsMonth % 12) + 1;
-     int nextYear = (bsMonth == 12) ? bsYear + 1 : bsYear;
-     toGregorian(bsYear, bsMonth, 1, gYear, gMonth, gDay);
-     double julian_date_start = getJulianDate(gYear, gMonth, gDay);
-     toGregorian(nextYear, nextMonth, 1, gYear, gMonth, gDay);
-     double julian_date_end = getJulianDate(gYear, gMonth, gDay);
-     return static_cast<int>(julian_date_end - julian_date_start);
+     BIKRAM_COUNT(FALLBACKS);
+     BIKRAM_TIME_START();
+     YearStructure year = astronomicalYear(bsYear);
+     int days = year.monthStart[bsMonth] - year.monthStart[bsMonth - 1];
+     if (bsMonth == 12 && bsYear + 1 == BS_START_YEAR) {
+         // Chaitra before the table ends where the table begins
+         days = static_cast<int>(TABLE_START_JDN - AHAR_JDN_OFFSET - year.startAhar - year.monthStart[11]);
+     }
+     BIKRAM_TIME_STOP(FALLBACK_CONVERSION);
+     return days;
+ }
+ 
+ inline long Bikram::bsToJulianDay(int bsYear, int bsMonth, int bsDay) {
+     if (bsYear >= BS_START_YEAR && bsYear < BS_START_YEAR + NP_DATA_YEAR_COUNT) {
+         BIKRAM_COUNT(TABLE_HITS);
+         return TABLE_START_JDN + TABLE_INDEX.monthStart[bsYear - BS_START_YEAR][bsMonth - 1] + (bsDay - 1);
+     }
+     BIKRAM_COUNT(FALLBACKS);
+     YearStructure year = astronomicalYear(bsYear);
+     return year.startAhar + year.monthStart[bsMonth - 1] + (bsDay - 1) + AHAR_JDN_OFFSET;
+ }
+
+ inline long Bikram::sankranti(int bsYear, int bsMonth, int& minute) {
+     // The model starts a month on the day during which the sun crosses the sign boundary.
+     // Bisect that day until the crossing is pinned to well under a minute.
+     YearStructure year = astronomicalYear(bsYear);
+     long ahar = year.startAhar + year.monthStart[bsMonth - 1];
+     double before = 0, after = 1;
+     for (int step = 0; step < 12; ++step) {
+         double middle = (before + after) / 2;
+         double tslong = getTslongAt(ahar + middle);
+         BIKRAM_COUNT(TSLONG_EVALUATIONS);
+         tslong -= std::floor(tslong / 30) * 30;
+         (tslong < 15 ? after : before) = middle;
+     }
+     minute = static_cast<int>(after * 1440);
+     if (minute > 1439) minute = 1439;
+     return ahar + AHAR_JDN_OFFSET;
+ }
+ 
+ inline void Bikram::fromJulianDayBs(long jdn) {
+     BsDate date = bsDate(jdn);
+     Year = date.year;
+     Month = date.month;
+     Day = date.day;
+ }
+ 
+ inline void Bikram::addDays(int bsYear, int bsMonth, int bsDay, long days) {
+     fromJulianDayBs(bsToJulianDay(bsYear, bsMonth, bsDay) + days);
+ }
+ 
+ inline void Bikram::addMonths(int bsYear, int bsMonth, int bsDay, long months) {
+     long index = bsYear * 12L + (bsMonth - 1) + months;
+     long year = (index >= 0 ? index : index - 11) / 12;
+     Year = static_cast<int>(year);
+     Month = static_cast<int>(index - year * 12) + 1;
+     int length = daysInMonth(Year, Month);
+     Day = bsDay < length ? bsDay : length;
+ }
+ 
+ inline long Bikram::daysBetween(int fromYear, int fromMonth, int fromDay, int toYear, int toMonth, int toDay) {
+     return bsToJulianDay(toYear, toMonth, toDay) - bsToJulianDay(fromYear, fromMonth, fromDay);
+ }
+ 
+ inline long Bikram::monthsBetween(int fromYear, int fromMonth, int fromDay, int toYear, int toMonth, int toDay) {
+     long months = (toYear * 12L + toMonth) - (fromYear * 12L + fromMonth);
+     long target = bsToJulianDay(toYear, toMonth, toDay);
+     // The month count is off by at most one when the day of month has not been reached yet
+     Bikram moved;
+     moved.addMonths(fromYear, fromMonth, fromDay, months);
+     long reached = bsToJulianDay(moved.Year, moved.Month, moved.Day);
+     if (months > 0 && reached > target) --months;
+     if (months < 0 && reached < target) ++months;
+     return months;
+ }
+ 
+ // One day in both calendars
+ struct BikramDatePair {
+     long jdn;
+     int bsYear, bsMonth, bsDay;
+     int adYear, adMonth, adDay;
+     int weekday; // 0 = Sunday
+ };
+ 
+ // Walks forward over consecutive days. Only the starting day is converted; each step then
+ // carries the BS and AD day, month and year forward, looking up one month length per month
+ // crossed, so advancing by a day is O(1).
+ class BikramDayIterator {
+ public:
+     explicit BikramDayIterator(long jdn);
+ 
+     const BikramDatePair& operator*() const { return current; }
+     const BikramDatePair* operator->() const { return &current; }
+     BikramDayIterator& operator++() { return advance(1); }
+     bool operator==(const BikramDayIterator& other) const { return current.jdn == other.current.jdn; }
+     bool operator!=(const BikramDayIterator& other) const { return current.jdn != other.current.jdn; }
+ 
+     // Move forward by days (>= 0)
+     BikramDayIterator& advance(long days);
+     // Length of the current BS month
+     int bsMonthDays() const { return bsMonthLength; }
+ 
+ private:
+     Bikram bs;
+     BikramDatePair current;
+     int bsMonthLength;
+ };
+ 
+ inline BikramDayIterator::BikramDayIterator(long jdn) {
+     current.jdn = jdn;
+     Bikram::fromJulianDay(jdn, current.adYear, current.adMonth, current.adDay);
+     bs.fromGregorian(current.adYear, current.adMonth, current.adDay);
+     current.bsYear = bs.getYear();
+     current.bsMonth = bs.getMonth();
+     current.bsDay = bs.getDay();
+     current.weekday = static_cast<int>(((jdn + 1) % 7 + 7) % 7);
+     bsMonthLength = bs.daysInMonth(current.bsYear, current.bsMonth);
+ }
+ 
+ inline BikramDayIterator& BikramDayIterator::advance(long days) {
+     current.jdn += days;
+     current.weekday = static_cast<int>((current.weekday + days) % 7);
+ 
+     long adDay = current.adDay + days;
+     for (int length; adDay > (length = Bikram::gregorianDaysInMonth(current.adYear, current.adMonth)); ) {
+         adDay -= length;
+         if (++current.adMonth > 12) {
+             current.adMonth = 1;
+             ++current.adYear;
+         }
+     }
+     current.adDay = static_cast<int>(adDay);
+ 
+     long bsDay = current.bsDay + days;
+     while (bsDay > bsMonthLength) {
+         bsDay -= bsMonthLength;
+         if (++current.bsMonth > 12) {
+             current.bsMonth = 1;
+             ++current.bsYear;
+         }
+         bsMonthLength = bs.daysInMonth(current.bsYear, current.bsMonth);
+     }
+     current.bsDay = static_cast<int>(bsDay);
+     return *this;
  }
  
  #endif // BIKRAM_H
\ No newline at end of file
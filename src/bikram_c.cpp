@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2024 Khumnath CG
+ * Email: nath.khum@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ #include "bikram_c.h"
+ #include "bikram.h"
+ #include "bikram_events.h"
+ #include <new>
+
+ static_assert(BIKRAM_STATS_HISTOGRAM_BUCKETS == bikram_stats::HISTOGRAM_BUCKETS, "histogram sizes differ");
+
+ #ifndef BIKRAM_VERSION
+ #define BIKRAM_VERSION "unknown"
+ #endif
+
+ namespace {
+
+ // Years outside this range are rejected rather than sent through the astronomical model
+ const int32_t MIN_YEAR = 1;
+ const int32_t MAX_YEAR = 9999;
+
+ bool validBs(int32_t year, int32_t month, int32_t day) {
+     return year >= MIN_YEAR && year <= MAX_YEAR && month >= 1 && month <= 12 && day >= 1 &&
+            day <= Bikram::daysInBsMonth(year, month);
+ }
+
+ bool convertToBs(int32_t year, int32_t month, int32_t day, bikram_date* out) {
+     if (year < MIN_YEAR || year > MAX_YEAR || month < 1 || month > 12 || day < 1 ||
+         day > Bikram::gregorianDaysInMonth(year, month)) {
+         return false;
+     }
+     BsDate bs = Bikram::toBs({year, month, day});
+     *out = {bs.year, bs.month, bs.day};
+     return true;
+ }
+
+ bool convertToAd(int32_t year, int32_t month, int32_t day, bikram_date* out) {
+     if (!validBs(year, month, day)) {
+         return false;
+     }
+     AdDate ad = Bikram::toAd({year, month, day});
+     *out = {ad.year, ad.month, ad.day};
+     return true;
+ }
+
+ // Copy an arithmetic result out, rejecting dates outside the supported years
+ int storeResult(const Bikram& bs, bikram_date* out) {
+     if (bs.getYear() < MIN_YEAR || bs.getYear() > MAX_YEAR) return -1;
+     out->year = bs.getYear();
+     out->month = bs.getMonth();
+     out->day = bs.getDay();
+     return 0;
+ }
+
+ bool validBs(const bikram_date* date) {
+     return date && validBs(date->year, date->month, date->day);
+ }
+
+ bikram_date bsOf(long jdn) {
+     BsDate bs = Bikram::bsDate(jdn);
+     return {bs.year, bs.month, bs.day};
+ }
+
+ int storeSankranti(const SankrantiTime& time, bikram_sankranti* out) {
+     out->date = bsOf(time.jdn);
+     out->month = time.bsMonth;
+     out->minute = time.minute;
+     out->model_day = time.modelDay;
+     return 0;
+ }
+
+ // Copy holiday i out, or fail if there is no such holiday
+ int storeHoliday(const HolidayCalendar& calendar, size_t i, bikram_date* date, const char** name) {
+     if (i >= calendar.size()) return -1;
+     if (date) *date = bsOf(calendar.day(i));
+     if (name) *name = calendar.name(i);
+     return 0;
+ }
+
+ template <typename Convert>
+ size_t convertDates(const bikram_date* in, bikram_date* out, size_t count, Convert convert) {
+     size_t invalid = 0;
+     for (size_t i = 0; i < count; ++i) {
+         bikram_date result;
+         if (!convert(in[i].year, in[i].month, in[i].day, &result)) {
+             result.year = result.month = result.day = 0;
+             ++invalid;
+         }
+         out[i] = result;
+     }
+     return invalid;
+ }
+
+ template <typename Convert>
+ size_t convertPacked(const int32_t* in, int32_t* out, size_t count, Convert convert) {
+     size_t invalid = 0;
+     for (size_t i = 0; i < count; ++i) {
+         int32_t packed = in[i];
+         bikram_date result;
+         if (packed > 0 && convert(packed / 10000, packed / 100 % 100, packed % 100, &result)) {
+             out[i] = result.year * 10000 + result.month * 100 + result.day;
+         } else {
+             out[i] = 0;
+             ++invalid;
+         }
+     }
+     return invalid;
+ }
+
+ } // namespace
+
+ struct bikram_holidays {
+     HolidayCalendar calendar;
+ };
+
+ // Build a calendar in malloc'd memory (not operator new, which would need the C++ runtime)
+ template <typename Load>
+ static bikram_holidays* newHolidays(int* errorLine, Load load) {
+     void* memory = std::malloc(sizeof(bikram_holidays));
+     if (!memory) {
+         if (errorLine) *errorLine = 0;
+         return nullptr;
+     }
+     bikram_holidays* holidays = new (memory) bikram_holidays();
+     if (!load(holidays->calendar)) {
+         if (errorLine) *errorLine = holidays->calendar.errorLine();
+         bikram_holidays_free(holidays);
+         return nullptr;
+     }
+     return holidays;
+ }
+
+ extern "C" {
+
+ const char* bikram_version(void) {
+     return BIKRAM_VERSION;
+ }
+
+ int bikram_ad_to_bs(int32_t year, int32_t month, int32_t day, bikram_date* out) {
+     return out && convertToBs(year, month, day, out) ? 0 : -1;
+ }
+
+ int bikram_bs_to_ad(int32_t year, int32_t month, int32_t day, bikram_date* out) {
+     return out && convertToAd(year, month, day, out) ? 0 : -1;
+ }
+
+ int bikram_days_in_month(int32_t bs_year, int32_t bs_month) {
+     if (bs_year < MIN_YEAR || bs_year > MAX_YEAR || bs_month < 1 || bs_month > 12) {
+         return -1;
+     }
+     return Bikram::daysInBsMonth(bs_year, bs_month);
+ }
+
+ int bikram_bs_add_days(int32_t year, int32_t month, int32_t day, int64_t days, bikram_date* out) {
+     Bikram bs;
+     // Keeps the sum far from overflow; the result is range-checked anyway
+     if (!out || !validBs(year, month, day) || days < -MAX_YEAR * 366LL || days > MAX_YEAR * 366LL) return -1;
+     bs.addDays(year, month, day, static_cast<long>(days));
+     return storeResult(bs, out);
+ }
+
+ int bikram_bs_add_months(int32_t year, int32_t month, int32_t day, int64_t months, bikram_date* out) {
+     Bikram bs;
+     if (!out || !validBs(year, month, day) || months < -MAX_YEAR * 12LL || months > MAX_YEAR * 12LL) return -1;
+     bs.addMonths(year, month, day, static_cast<long>(months));
+     return storeResult(bs, out);
+ }
+
+ int bikram_bs_diff(const bikram_date* from, const bikram_date* to, int64_t* days, int64_t* months) {
+     if (!from || !to || !validBs(from->year, from->month, from->day) || !validBs(to->year, to->month, to->day)) {
+         return -1;
+     }
+     if (days) *days = Bikram::daysBetween(from->year, from->month, from->day, to->year, to->month, to->day);
+     if (months) *months = Bikram::monthsBetween(from->year, from->month, from->day, to->year, to->month, to->day);
+     return 0;
+ }
+
+ size_t bikram_ad_to_bs_batch(const bikram_date* in, bikram_date* out, size_t count) {
+     return convertDates(in, out, count, convertToBs);
+ }
+
+ size_t bikram_bs_to_ad_batch(const bikram_date* in, bikram_date* out, size_t count) {
+     return convertDates(in, out, count, convertToAd);
+ }
+
+ size_t bikram_ad_to_bs_packed(const int32_t* in, int32_t* out, size_t count) {
+     return convertPacked(in, out, count, convertToBs);
+ }
+
+ size_t bikram_bs_to_ad_packed(const int32_t* in, int32_t* out, size_t count) {
+     return convertPacked(in, out, count, convertToAd);
+ }
+
+ int bikram_sankranti_of(int32_t bs_year, int32_t bs_month, bikram_sankranti* out) {
+     if (!out || bs_year < MIN_YEAR || bs_year > MAX_YEAR || bs_month < 1 || bs_month > 12) return -1;
+     return storeSankranti(Sankranti::of(bs_year, bs_month), out);
+ }
+
+ int bikram_sankranti_next(const bikram_date* from, bikram_sankranti* out) {
+     if (!out || !validBs(from) || (from->year == MAX_YEAR && from->month == 12)) return -1;
+     return storeSankranti(Sankranti::next(Bikram::bsToJulianDay(from->year, from->month, from->day)), out);
+ }
+
+ int bikram_sankranti_prev(const bikram_date* from, bikram_sankranti* out) {
+     if (!out || !validBs(from) || (from->year == MIN_YEAR && from->month == 1)) return -1;
+     return storeSankranti(Sankranti::previous(Bikram::bsToJulianDay(from->year, from->month, from->day)), out);
+ }
+
+ bikram_holidays* bikram_holidays_load(const char* path, int* error_line) {
+     return newHolidays(error_line, [path](HolidayCalendar& calendar) { return path && calendar.load(path); });
+ }
+
+ bikram_holidays* bikram_holidays_parse(const char* text, size_t length, int* error_line) {
+     return newHolidays(error_line, [text, length](HolidayCalendar& calendar) {
+         return (text || length == 0) && calendar.parse(text, length);
+     });
+ }
+
+ void bikram_holidays_free(bikram_holidays* holidays) {
+     if (!holidays) return;
+     holidays->~bikram_holidays();
+     std::free(holidays);
+ }
+
+ int bikram_holiday_is(const bikram_holidays* holidays, const bikram_date* date, const char** name) {
+     if (!holidays || !validBs(date)) return -1;
+     long jdn = Bikram::bsToJulianDay(date->year, date->month, date->day);
+     if (!holidays->calendar.isHoliday(jdn)) return 0;
+     if (name) *name = holidays->calendar.name(holidays->calendar.lowerBound(jdn));
+     return 1;
+ }
+
+ int bikram_holiday_next(const bikram_holidays* holidays, const bikram_date* from, bikram_date* date, const char** name) {
+     if (!holidays || !validBs(from)) return -1;
+     long jdn = Bikram::bsToJulianDay(from->year, from->month, from->day);
+     return storeHoliday(holidays->calendar, holidays->calendar.lowerBound(jdn), date, name);
+ }
+
+ int bikram_holiday_prev(const bikram_holidays* holidays, const bikram_date* from, bikram_date* date, const char** name) {
+     if (!holidays || !validBs(from)) return -1;
+     long jdn = Bikram::bsToJulianDay(from->year, from->month, from->day);
+     return storeHoliday(holidays->calendar, holidays->calendar.previous(jdn), date, name);
+ }
+
+ size_t bikram_holidays_between(const bikram_holidays* holidays, const bikram_date* from, const bikram_date* to,
+                                bikram_date* dates, const char** names, size_t capacity) {
+     if (!holidays || !validBs(from) || !validBs(to)) return 0;
+     size_t begin, end;
+     holidays->calendar.range(Bikram::bsToJulianDay(from->year, from->month, from->day),
+                              Bikram::bsToJulianDay(to->year, to->month, to->day), begin, end);
+     for (size_t i = begin; i < end && i - begin < capacity; ++i) {
+         storeHoliday(holidays->calendar, i, dates ? &dates[i - begin] : nullptr, names ? &names[i - begin] : nullptr);
+     }
+     return end - begin;
+ }
+
+ int bikram_stats_enabled(void) {
+     return BIKRAM_STATS_ENABLED;
+ }
+
+ void bikram_stats_get(bikram_engine_stats* out) {
+     if (!out) return;
+     bikram_stats::Snapshot snap;
+     bikram_stats::snapshot(snap);
+     out->table_hits = snap.counters[bikram_stats::TABLE_HITS];
+     out->fallbacks = snap.counters[bikram_stats::FALLBACKS];
+     out->year_cache_hits = snap.counters[bikram_stats::YEAR_CACHE_HITS];
+     out->year_cache_misses = snap.counters[bikram_stats::YEAR_CACHE_MISSES];
+     out->solver_runs = snap.counters[bikram_stats::SOLVER_RUNS];
+     out->solver_steps = snap.counters[bikram_stats::SOLVER_STEPS];
+     out->solver_max_steps = snap.maxSolverSteps;
+     out->tslong_evaluations = snap.counters[bikram_stats::TSLONG_EVALUATIONS];
+     for (int b = 0; b < BIKRAM_STATS_HISTOGRAM_BUCKETS; ++b) {
+         out->fallback_ns[b] = snap.histograms[bikram_stats::FALLBACK_CONVERSION][b];
+         out->year_compute_ns[b] = snap.histograms[bikram_stats::YEAR_COMPUTE][b];
+     }
+ }
+
+ void bikram_stats_reset(void) {
+     bikram_stats::reset();
+ }
+
+ } // extern "C"
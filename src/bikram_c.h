@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2024 Khumnath CG
+ * Email: nath.khum@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ /*
+  * C interface of libbikram.
+  *
+  * Every function is thread-safe, and only loading a holiday calendar allocates, so the batch
+  * functions can convert millions of dates per call from C, Go (cgo) or Python (ctypes)
+  * without any per-date FFI or allocation cost.
+  *
+  * Packed dates are int32 values of the form yyyymmdd, e.g. 20820514 for 2082-05-14.
+  * Batch functions write 0 for entries that are not valid dates and return how many such
+  * entries there were.
+  */
+
+ #ifndef BIKRAM_C_H
+ #define BIKRAM_C_H
+
+ #include <stddef.h>
+ #include <stdint.h>
+
+ #if defined(_WIN32)
+ #  ifdef BIKRAM_BUILDING_LIBRARY
+ #    define BIKRAM_API __declspec(dllexport)
+ #  else
+ #    define BIKRAM_API
+ #  endif
+ #else
+ #  define BIKRAM_API __attribute__((visibility("default")))
+ #endif
+
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+
+ typedef struct bikram_date {
+     int32_t year;
+     int32_t month;
+     int32_t day;
+ } bikram_date;
+
+ /* Library version, e.g. "2.0.0" */
+ BIKRAM_API const char* bikram_version(void);
+
+ /* Single conversions. Return 0 on success, -1 if the input is not a valid date. */
+ BIKRAM_API int bikram_ad_to_bs(int32_t year, int32_t month, int32_t day, bikram_date* out);
+ BIKRAM_API int bikram_bs_to_ad(int32_t year, int32_t month, int32_t day, bikram_date* out);
+
+ /* Number of days in a BS month, or -1 for an invalid month. */
+ BIKRAM_API int bikram_days_in_month(int32_t bs_year, int32_t bs_month);
+
+ /* BS date arithmetic. The add functions move by days, or by calendar months with the day
+  * clamped to the length of the target month. Return 0 on success, -1 if the input or the
+  * result is not a valid date. */
+ BIKRAM_API int bikram_bs_add_days(int32_t year, int32_t month, int32_t day, int64_t days, bikram_date* out);
+ BIKRAM_API int bikram_bs_add_months(int32_t year, int32_t month, int32_t day, int64_t months, bikram_date* out);
+
+ /* Signed distance from one BS date to another, in days and in whole months (either output may
+  * be NULL). Returns 0 on success, -1 if either date is invalid. */
+ BIKRAM_API int bikram_bs_diff(const bikram_date* from, const bikram_date* to, int64_t* days, int64_t* months);
+
+ /* Batch conversions over arrays of count entries. in and out may be the same array. */
+ BIKRAM_API size_t bikram_ad_to_bs_batch(const bikram_date* in, bikram_date* out, size_t count);
+ BIKRAM_API size_t bikram_bs_to_ad_batch(const bikram_date* in, bikram_date* out, size_t count);
+ BIKRAM_API size_t bikram_ad_to_bs_packed(const int32_t* in, int32_t* out, size_t count);
+ BIKRAM_API size_t bikram_bs_to_ad_packed(const int32_t* in, int32_t* out, size_t count);
+
+ /* Sankranti: the moment the sun enters the sign that begins a BS month. date is the day the
+  * calendar keeps it on (the 1st of month in the month table), month the BS month it begins,
+  * and minute the minutes after the astronomical model's midnight (mean midnight at Ujjain) on
+  * the day model_day days from date. model_day is 0 except where the month table moves a
+  * month start off the model's sankranti day (77 months of 2000-2099 BS), where it is -1 or 1. */
+ typedef struct bikram_sankranti {
+     bikram_date date;
+     int32_t month;
+     int32_t minute;
+     int32_t model_day;
+ } bikram_sankranti;
+
+ /* Sankranti beginning a BS month, or the first on or after / last on or before a BS date.
+  * Return 0 on success, -1 if the input is not valid. */
+ BIKRAM_API int bikram_sankranti_of(int32_t bs_year, int32_t bs_month, bikram_sankranti* out);
+ BIKRAM_API int bikram_sankranti_next(const bikram_date* from, bikram_sankranti* out);
+ BIKRAM_API int bikram_sankranti_prev(const bikram_date* from, bikram_sankranti* out);
+
+ /* Holiday calendars, loaded from text with one "YYYY-MM-DD Name" line per BS date or
+  * "YYYY-MM-DD..YYYY-MM-DD Name" for a run of days; '#' starts a comment line. Loading returns
+  * NULL on failure and sets *error_line (if given) to the bad line, or 0 if the file could
+  * not be read. A loaded calendar is read-only, so any number of threads may query it.
+  * Names stay valid until the calendar is freed. */
+ typedef struct bikram_holidays bikram_holidays;
+
+ BIKRAM_API bikram_holidays* bikram_holidays_load(const char* path, int* error_line);
+ BIKRAM_API bikram_holidays* bikram_holidays_parse(const char* text, size_t length, int* error_line);
+ BIKRAM_API void bikram_holidays_free(bikram_holidays* holidays);
+
+ /* 1 if a BS date is a holiday (name, if given, gets the first one listed), 0 if not, -1 if the
+  * date is invalid. */
+ BIKRAM_API int bikram_holiday_is(const bikram_holidays* holidays, const bikram_date* date, const char** name);
+
+ /* First holiday on or after / last on or before a BS date. Return 0, or -1 if there is none or
+  * the date is invalid. */
+ BIKRAM_API int bikram_holiday_next(const bikram_holidays* holidays, const bikram_date* from, bikram_date* date, const char** name);
+ BIKRAM_API int bikram_holiday_prev(const bikram_holidays* holidays, const bikram_date* from, bikram_date* date, const char** name);
+
+ /* Holidays from one BS date to another inclusive. Writes the first capacity of them to dates
+  * and names (either may be NULL) and returns how many there are; 0 for invalid dates. */
+ BIKRAM_API size_t bikram_holidays_between(const bikram_holidays* holidays, const bikram_date* from, const bikram_date* to,
+                                           bikram_date* dates, const char** names, size_t capacity);
+
+ /* Engine counters, summed over all threads. They are only collected when libbikram is built
+  * with -DBIKRAM_STATS=ON; otherwise bikram_stats_enabled() returns 0 and snapshots stay zero.
+  * Histogram bucket i counts calls that took [2^i, 2^(i+1)) nanoseconds. */
+ #define BIKRAM_STATS_HISTOGRAM_BUCKETS 32
+
+ typedef struct bikram_engine_stats {
+     uint64_t table_hits;         /* answered from the month table */
+     uint64_t fallbacks;          /* answered by the astronomical model */
+     uint64_t year_cache_hits;
+     uint64_t year_cache_misses;
+     uint64_t solver_runs;        /* month starts searched by the sankranti solver */
+     uint64_t solver_steps;       /* days tested by those searches */
+     uint64_t solver_max_steps;   /* most days tested by one search */
+     uint64_t tslong_evaluations; /* solar longitudes computed */
+     uint64_t fallback_ns[BIKRAM_STATS_HISTOGRAM_BUCKETS];
+     uint64_t year_compute_ns[BIKRAM_STATS_HISTOGRAM_BUCKETS];
+ } bikram_engine_stats;
+
+ BIKRAM_API int bikram_stats_enabled(void);
+ BIKRAM_API void bikram_stats_get(bikram_engine_stats* out);
+ BIKRAM_API void bikram_stats_reset(void);
+
+ #ifdef __cplusplus
+ }
+ #endif
+
+ #endif /* BIKRAM_C_H */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2024 Khumnath CG
+ * Email: nath.khum@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Sankranti instants and holiday calendars, keyed by Julian Day Number like the rest of the engine.
+ //
+ // Both are built for libbikram as well as the CLI, so they allocate with malloc and keep no
+ // C++ runtime dependencies.
+
+ #ifndef BIKRAM_EVENTS_H
+ #define BIKRAM_EVENTS_H
+
+ #include "bikram.h"
+ #include <algorithm>
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+
+ // The moment the sun enters a sign, which begins a BS month
+ struct SankrantiTime {
+     int bsYear;
+     int bsMonth;  // month it begins: 1 (Baisakh) when the sun enters Mesh
+     long jdn;     // day the calendar keeps it on: the 1st of bsMonth in the month table
+     int minute;   // minutes after the model's midnight (mean midnight at Ujjain)
+     int modelDay; // day of minute relative to jdn: 0, or -1/+1 where the table moves the month start
+ };
+
+ class Sankranti {
+ public:
+     // From the generated index when it covers the year, otherwise from the astronomical model
+     static SankrantiTime of(int bsYear, int bsMonth);
+     // First sankranti falling on or after day jdn, and last falling on or before it: the
+     // sankranti of jdn's own month, or of the next one if jdn is past its 1st.
+     static SankrantiTime next(long jdn);
+     static SankrantiTime previous(long jdn);
+ };
+
+ inline SankrantiTime Sankranti::of(int bsYear, int bsMonth) {
+     SankrantiTime time{bsYear, bsMonth, Bikram::bsToJulianDay(bsYear, bsMonth, 1), 0, 0};
+ #ifdef BIKRAM_GENERATED_TABLE
+     constexpr int count = sizeof(BIKRAM_SANKRANTI_DATA) / sizeof(BIKRAM_SANKRANTI_DATA[0]);
+     int index = (bsYear - BIKRAM_TABLE_START_YEAR) * 12 + bsMonth - 1;
+     if (bsYear >= BIKRAM_TABLE_START_YEAR && index < count) {
+         BIKRAM_COUNT(TABLE_HITS);
+         int minutes = BIKRAM_SANKRANTI_DATA[index];
+         time.modelDay = (minutes >= 0 ? minutes : minutes - 1439) / 1440;
+         time.minute = minutes - time.modelDay * 1440;
+         return time;
+     }
+ #endif
+     BIKRAM_COUNT(FALLBACKS);
+     time.modelDay = static_cast<int>(Bikram::sankranti(bsYear, bsMonth, time.minute) - time.jdn);
+     return time;
+ }
+
+ inline SankrantiTime Sankranti::next(long jdn) {
+     BsDate date = Bikram::bsDate(jdn);
+     if (date.day == 1) return of(date.year, date.month);
+     return date.month == 12 ? of(date.year + 1, 1) : of(date.year, date.month + 1);
+ }
+
+ inline SankrantiTime Sankranti::previous(long jdn) {
+     BsDate date = Bikram::bsDate(jdn);
+     return of(date.year, date.month);
+ }
+
+ // Holidays read from text with one "YYYY-MM-DD Name" line per BS date, or
+ // "YYYY-MM-DD..YYYY-MM-DD Name" for a run of up to 366 days. Blank lines and lines starting
+ // with '#' are skipped. Days are kept sorted in one array of 32-bit JDNs with a bucket index
+ // over 32-day blocks, so a lookup reads one bucket entry and a line or two of days.
+ class HolidayCalendar {
+ public:
+     HolidayCalendar() = default;
+     ~HolidayCalendar() { clear(); }
+     HolidayCalendar(const HolidayCalendar&) = delete;
+     HolidayCalendar& operator=(const HolidayCalendar&) = delete;
+
+     // Replace the calendar with a file or a buffer. On failure the calendar is left empty and
+     // errorLine() is the offending line, or 0 if the file could not be read.
+     bool load(const char* path);
+     bool parse(const char* input, std::size_t length);
+     int errorLine() const { return badLine; }
+
+     // Holidays in date order; several may share a day, in the order they were listed
+     std::size_t size() const { return count; }
+     long day(std::size_t i) const { return days[i]; }
+     const char* name(std::size_t i) const { return text + nameStart[i]; }
+
+     // Index of the first holiday on or after jdn, or size() if there is none
+     std::size_t lowerBound(long jdn) const;
+     // Index of the last holiday on or before jdn, or size() if there is none
+     std::size_t previous(long jdn) const {
+         std::size_t i = lowerBound(jdn + 1);
+         return i == 0 ? count : i - 1;
+     }
+     bool isHoliday(long jdn) const {
+         std::size_t i = lowerBound(jdn);
+         return i < count && days[i] == jdn;
+     }
+     // Holidays from first to last inclusive are the indices [begin, end)
+     void range(long first, long last, std::size_t& begin, std::size_t& end) const {
+         begin = lowerBound(first);
+         end = last < first ? begin : lowerBound(last + 1);
+     }
+
+ private:
+     static constexpr int BUCKET_SHIFT = 5;
+     static constexpr long MAX_RUN = 366;
+
+     struct Entry {
+         std::int32_t day;
+         std::uint32_t name;
+         std::uint32_t order;
+     };
+
+     static bool readDay(const char*& p, long& jdn);
+     bool fail(int line, Entry* entries);
+     void clear();
+
+     char* text = nullptr; // copy of the input with each name NUL-terminated in place
+     std::int32_t* days = nullptr;
+     std::uint32_t* nameStart = nullptr;
+     std::uint32_t* buckets = nullptr; // buckets[b]: first index on or after days[0] + (b << BUCKET_SHIFT)
+     std::size_t count = 0;
+     int badLine = 0;
+ };
+
+ inline std::size_t HolidayCalendar::lowerBound(long jdn) const {
+     if (count == 0 || jdn <= days[0]) return 0;
+     if (jdn > days[count - 1]) return count;
+     std::size_t bucket = static_cast<std::size_t>(jdn - days[0]) >> BUCKET_SHIFT;
+     std::size_t i = buckets[bucket];
+     std::size_t end = buckets[bucket + 1];
+     while (i < end && days[i] < jdn) ++i;
+     return i;
+ }
+
+ // Reads a YYYY-MM-DD BS date and advances p past it
+ inline bool HolidayCalendar::readDay(const char*& p, long& jdn) {
+     int fields[3] = {0, 0, 0};
+     const int widths[3] = {4, 2, 2};
+     for (int f = 0; f < 3; ++f) {
+         if (f > 0 && *p++ != '-') return false;
+         int digits = 0;
+         for (; *p >= '0' && *p <= '9' && digits < widths[f]; ++p, ++digits) fields[f] = fields[f] * 10 + (*p - '0');
+         if (digits == 0) return false;
+     }
+     int year = fields[0], month = fields[1], day = fields[2];
+     if (year < 1 || month < 1 || month > 12 || day < 1 || day > Bikram::daysInBsMonth(year, month)) return false;
+     jdn = Bikram::bsToJulianDay(year, month, day);
+     return true;
+ }
+
+ inline bool HolidayCalendar::load(const char* path) {
+     clear();
+     std::FILE* file = std::fopen(path, "rb");
+     if (!file) return fail(0, nullptr);
+     char* input = nullptr;
+     std::size_t length = 0, capacity = 0;
+     for (;;) {
+         if (length == capacity) {
+             capacity = capacity ? capacity * 2 : 64 * 1024;
+             char* grown = static_cast<char*>(std::realloc(input, capacity));
+             if (!grown) break;
+             input = grown;
+         }
+         std::size_t got = std::fread(input + length, 1, capacity - length, file);
+         length += got;
+         if (got == 0) break;
+     }
+     bool ok = !std::ferror(file) && length < capacity;
+     std::fclose(file);
+     ok = ok && parse(input, length);
+     std::free(input);
+     return ok || fail(badLine, nullptr);
+ }
+
+ inline bool HolidayCalendar::parse(const char* input, std::size_t length) {
+     clear();
+     text = static_cast<char*>(std::malloc(length + 1));
+     if (!text || length > UINT32_MAX) return fail(0, nullptr);
+     if (length) std::memcpy(text, input, length);
+     text[length] = '\0';
+
+     Entry* entries = nullptr;
+     std::size_t used = 0, capacity = 0;
+     int line = 0;
+     for (char* p = text; p < text + length;) {
+         ++line;
+         char* end = static_cast<char*>(std::memchr(p, '\n', text + length - p));
+         char* next = end ? end + 1 : text + length;
+         if (!end) end = text + length;
+         while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) --end;
+         *end = '\0';
+         while (*p == ' ' || *p == '\t') ++p;
+         if (*p == '\0' || *p == '#') {
+             p = next;
+             continue;
+         }
+
+         const char* c = p;
+         long first, last;
+         if (!readDay(c, first)) return fail(line, entries);
+         last = first;
+         if (c[0] == '.' && c[1] == '.') {
+             c += 2;
+             if (!readDay(c, last) || last < first || last - first >= MAX_RUN) return fail(line, entries);
+         }
+         if (*c != ' ' && *c != '\t') return fail(line, entries);
+         while (*c == ' ' || *c == '\t') ++c;
+
+         for (long d = first; d <= last; ++d) {
+             if (used == capacity) {
+                 capacity = capacity ? capacity * 2 : 256;
+                 Entry* grown = static_cast<Entry*>(std::realloc(entries, capacity * sizeof(Entry)));
+                 if (!grown) return fail(line, entries);
+                 entries = grown;
+             }
+             entries[used] = {static_cast<std::int32_t>(d), static_cast<std::uint32_t>(c - text), static_cast<std::uint32_t>(used)};
+             ++used;
+         }
+         p = next;
+     }
+
+     std::sort(entries, entries + used, [](const Entry& a, const Entry& b) {
+         return a.day != b.day ? a.day < b.day : a.order < b.order;
+     });
+
+     std::size_t bucketCount = used ? (static_cast<std::size_t>(entries[used - 1].day - entries[0].day) >> BUCKET_SHIFT) + 1 : 0;
+     days = static_cast<std::int32_t*>(std::malloc((used + 1) * sizeof(std::int32_t)));
+     nameStart = static_cast<std::uint32_t*>(std::malloc((used + 1) * sizeof(std::uint32_t)));
+     buckets = static_cast<std::uint32_t*>(std::malloc((bucketCount + 1) * sizeof(std::uint32_t)));
+     if (!days || !nameStart || !buckets) return fail(0, entries);
+     for (std::size_t i = 0; i < used; ++i) {
+         days[i] = entries[i].day;
+         nameStart[i] = entries[i].name;
+     }
+     std::size_t i = 0;
+     for (std::size_t b = 0; b < bucketCount; ++b) {
+         long start = entries[0].day + (static_cast<long>(b) << BUCKET_SHIFT);
+         while (i < used && days[i] < start) ++i;
+         buckets[b] = static_cast<std::uint32_t>(i);
+     }
+     buckets[bucketCount] = static_cast<std::uint32_t>(used);
+     count = used;
+     std::free(entries);
+     return true;
+ }
+
+ inline bool HolidayCalendar::fail(int line, Entry* entries) {
+     std::free(entries);
+     clear();
+     badLine = line;
+     return false;
+ }
+
+ inline void HolidayCalendar::clear() {
+     std::free(text);
+     std::free(days);
+     std::free(nameStart);
+     std::free(buckets);
+     text = nullptr;
+     days = nullptr;
+     nameStart = nullptr;
+     buckets = nullptr;
+     count = 0;
+     badLine = 0;
+ }
+
+ #endif // BIKRAM_EVENTS_H
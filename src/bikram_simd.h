@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2024 Khumnath CG
+ * Email: nath.khum@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Vector kernels for Bikram::getTslongBatch.
+ //
+ // The kernels follow getTslong step by step but replace libm sin/asin with polynomials:
+ // sin is reduced to [-pi/2, pi/2] and evaluated with its Taylor series up to x^17
+ // (error < 5e-14), and asin only ever sees |x| < 0.0385, where six series terms are exact
+ // to double precision. The resulting longitude differs from getTslong by ~1e-13 degrees.
+ // Only values that land on a 30 degree boundary can change a saura masa result, so
+ // getTslongBatch recomputes any value within TSLONG_BATCH_EPSILON of a boundary with the
+ // scalar code, which makes month boundaries identical to the scalar path.
+
+ #ifndef BIKRAM_SIMD_H
+ #define BIKRAM_SIMD_H
+
+ #include <cstddef>
+
+ #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+ #define BIKRAM_HAVE_X86_SIMD 1
+ #include <immintrin.h>
+ #endif
+
+ // Model constants, passed in so the kernels need no access to Bikram internals
+ struct BikramTslongParams {
+     double yugaRotationSun;
+     double yugaCivilDays;
+     double planetApogeeSun;
+     double planetCircummSun;
+     double rad;
+ };
+
+ // Distance (degrees) from a multiple of 30 below which a batch result is recomputed in scalar
+ constexpr double TSLONG_BATCH_EPSILON = 1e-7;
+
+ #ifdef BIKRAM_HAVE_X86_SIMD
+
+ namespace bikram_simd {
+
+ constexpr double PI = 3.14159265358979323846;
+
+ // Taylor coefficients of sin(x) = x * (1 + x^2 * (S1 + x^2 * (S2 + ...)))
+ constexpr double S1 = -1.0 / 6;
+ constexpr double S2 = 1.0 / 120;
+ constexpr double S3 = -1.0 / 5040;
+ constexpr double S4 = 1.0 / 362880;
+ constexpr double S5 = -1.0 / 39916800;
+ constexpr double S6 = 1.0 / 6227020800.0;
+ constexpr double S7 = -1.0 / 1307674368000.0;
+ constexpr double S8 = 1.0 / 355687428096000.0;
+
+ // Series of asin(x) = x * (1 + x^2 * (A1 + x^2 * (A2 + ...)))
+ constexpr double A1 = 1.0 / 6;
+ constexpr double A2 = 3.0 / 40;
+ constexpr double A3 = 5.0 / 112;
+ constexpr double A4 = 35.0 / 1152;
+ constexpr double A5 = 63.0 / 2816;
+
+ __attribute__((target("avx2"))) inline void tslongAvx2(const long* ahar, double* out, std::size_t count, const BikramTslongParams& p) {
+     const __m256d sun = _mm256_set1_pd(p.yugaRotationSun);
+     const __m256d civil = _mm256_set1_pd(p.yugaCivilDays);
+     const __m256d apogee = _mm256_set1_pd(p.planetApogeeSun);
+     const __m256d y1 = _mm256_set1_pd(p.planetCircummSun / 360);
+     const __m256d rad = _mm256_set1_pd(p.rad);
+     const __m256d full = _mm256_set1_pd(360);
+     const __m256d pi = _mm256_set1_pd(PI);
+     const __m256d halfPi = _mm256_set1_pd(PI / 2);
+     const __m256d threeHalfPi = _mm256_set1_pd(3 * PI / 2);
+     const __m256d twoPi = _mm256_set1_pd(2 * PI);
+     const __m256d one = _mm256_set1_pd(1);
+
+     std::size_t i = 0;
+     for (; i + 4 <= count; i += 4) {
+         __m256d a = _mm256_set_pd(static_cast<double>(ahar[i + 3]), static_cast<double>(ahar[i + 2]),
+                                   static_cast<double>(ahar[i + 1]), static_cast<double>(ahar[i]));
+         __m256d t1 = _mm256_div_pd(_mm256_mul_pd(sun, a), civil);
+         t1 = _mm256_sub_pd(t1, _mm256_round_pd(t1, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+         __m256d mslong = _mm256_mul_pd(full, t1);
+
+         __m256d x = _mm256_div_pd(_mm256_sub_pd(mslong, apogee), rad);
+         x = _mm256_blendv_pd(x, _mm256_sub_pd(x, twoPi), _mm256_cmp_pd(x, threeHalfPi, _CMP_GT_OQ));
+         x = _mm256_blendv_pd(x, _mm256_sub_pd(pi, x), _mm256_cmp_pd(x, halfPi, _CMP_GT_OQ));
+
+         __m256d x2 = _mm256_mul_pd(x, x);
+         __m256d s = _mm256_set1_pd(S8);
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S7));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S6));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S5));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S4));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S3));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S2));
+         s = _mm256_add_pd(_mm256_mul_pd(s, x2), _mm256_set1_pd(S1));
+         s = _mm256_mul_pd(x, _mm256_add_pd(_mm256_mul_pd(s, x2), one));
+
+         __m256d y = _mm256_mul_pd(y1, s);
+         __m256d y2 = _mm256_mul_pd(y, y);
+         __m256d as = _mm256_set1_pd(A5);
+         as = _mm256_add_pd(_mm256_mul_pd(as, y2), _mm256_set1_pd(A4));
+         as = _mm256_add_pd(_mm256_mul_pd(as, y2), _mm256_set1_pd(A3));
+         as = _mm256_add_pd(_mm256_mul_pd(as, y2), _mm256_set1_pd(A2));
+         as = _mm256_add_pd(_mm256_mul_pd(as, y2), _mm256_set1_pd(A1));
+         as = _mm256_mul_pd(y, _mm256_add_pd(_mm256_mul_pd(as, y2), one));
+
+         _mm256_storeu_pd(out + i, _mm256_sub_pd(mslong, _mm256_mul_pd(as, rad)));
+     }
+     if (i < count) {
+         // Pad the remainder to a full vector so it goes through the same arithmetic
+         long tail[4] = {ahar[i], ahar[i], ahar[i], ahar[i]};
+         double result[4];
+         std::size_t rest = count - i;
+         for (std::size_t k = 0; k < rest; ++k) tail[k] = ahar[i + k];
+         tslongAvx2(tail, result, 4, p);
+         for (std::size_t k = 0; k < rest; ++k) out[i + k] = result[k];
+     }
+ }
+
+ inline void tslongSse2(const long* ahar, double* out, std::size_t count, const BikramTslongParams& p) {
+     const __m128d sun = _mm_set1_pd(p.yugaRotationSun);
+     const __m128d civil = _mm_set1_pd(p.yugaCivilDays);
+     const __m128d apogee = _mm_set1_pd(p.planetApogeeSun);
+     const __m128d y1 = _mm_set1_pd(p.planetCircummSun / 360);
+     const __m128d rad = _mm_set1_pd(p.rad);
+     const __m128d full = _mm_set1_pd(360);
+     const __m128d pi = _mm_set1_pd(PI);
+     const __m128d halfPi = _mm_set1_pd(PI / 2);
+     const __m128d threeHalfPi = _mm_set1_pd(3 * PI / 2);
+     const __m128d twoPi = _mm_set1_pd(2 * PI);
+     const __m128d one = _mm_set1_pd(1);
+
+     auto select = [](__m128d mask, __m128d a, __m128d b) {
+         return _mm_or_pd(_mm_and_pd(mask, b), _mm_andnot_pd(mask, a));
+     };
+
+     std::size_t i = 0;
+     for (; i + 2 <= count; i += 2) {
+         __m128d a = _mm_set_pd(static_cast<double>(ahar[i + 1]), static_cast<double>(ahar[i]));
+         __m128d t1 = _mm_div_pd(_mm_mul_pd(sun, a), civil);
+         // Truncation through int32 is exact: t1 stays far below 2^31 for any representable date
+         t1 = _mm_sub_pd(t1, _mm_cvtepi32_pd(_mm_cvttpd_epi32(t1)));
+         __m128d mslong = _mm_mul_pd(full, t1);
+
+         __m128d x = _mm_div_pd(_mm_sub_pd(mslong, apogee), rad);
+         x = select(_mm_cmpgt_pd(x, threeHalfPi), x, _mm_sub_pd(x, twoPi));
+         x = select(_mm_cmpgt_pd(x, halfPi), x, _mm_sub_pd(pi, x));
+
+         __m128d x2 = _mm_mul_pd(x, x);
+         __m128d s = _mm_set1_pd(S8);
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S7));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S6));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S5));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S4));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S3));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S2));
+         s = _mm_add_pd(_mm_mul_pd(s, x2), _mm_set1_pd(S1));
+         s = _mm_mul_pd(x, _mm_add_pd(_mm_mul_pd(s, x2), one));
+
+         __m128d y = _mm_mul_pd(y1, s);
+         __m128d y2 = _mm_mul_pd(y, y);
+         __m128d as = _mm_set1_pd(A5);
+         as = _mm_add_pd(_mm_mul_pd(as, y2), _mm_set1_pd(A4));
+         as = _mm_add_pd(_mm_mul_pd(as, y2), _mm_set1_pd(A3));
+         as = _mm_add_pd(_mm_mul_pd(as, y2), _mm_set1_pd(A2));
+         as = _mm_add_pd(_mm_mul_pd(as, y2), _mm_set1_pd(A1));
+         as = _mm_mul_pd(y, _mm_add_pd(_mm_mul_pd(as, y2), one));
+
+         _mm_storeu_pd(out + i, _mm_sub_pd(mslong, _mm_mul_pd(as, rad)));
+     }
+     if (i < count) {
+         long tail[2] = {ahar[i], ahar[i]};
+         double result[2];
+         tslongSse2(tail, result, 2, p);
+         out[i] = result[0];
+     }
+ }
+
+ inline bool hasAvx2() {
+     // Reads the CPU model libgcc fills in at startup; cheap enough to call every time
+     return __builtin_cpu_supports("avx2");
+ }
+
+ } // namespace bikram_simd
+
+ #endif // BIKRAM_HAVE_X86_SIMD
+
+ #endif // BIKRAM_SIMD_H
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024 Khumnath CG
+ * Email: nath.khum@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Engine counters and latency histograms behind --stats and bikram_stats_get().
+ //
+ // Counting is compiled in only with -DBIKRAM_STATS=ON; otherwise the BIKRAM_COUNT and
+ // BIKRAM_TIME_* macros expand to nothing and snapshots stay zero. Each thread counts into its
+ // own block, so a hot path pays a plain increment and never shares a cache line with another
+ // thread. Blocks are linked into a global list on first use and never freed, so work done by
+ // worker threads that have already exited still shows up in a snapshot.
+
+ #ifndef BIKRAM_STATS_H
+ #define BIKRAM_STATS_H
+
+ #include <atomic>
+ #include <cstdint>
+ #include <cstdlib>
+ #include <new>
+ #include <time.h>
+
+ namespace bikram_stats {
+
+ enum Counter {
+     TABLE_HITS,         // conversions and month lengths answered from the month table
+     FALLBACKS,          // ... answered by the astronomical model instead
+     YEAR_CACHE_HITS,    // astronomical years found in the year cache
+     YEAR_CACHE_MISSES,  // astronomical years computed by the sankranti solver
+     SOLVER_RUNS,        // findSauraMasaStart calls
+     SOLVER_STEPS,       // days tested by findSauraMasaStart
+     TSLONG_EVALUATIONS, // solar longitudes computed (one sin and one asin each, scalar or SIMD)
+     COUNTER_COUNT
+ };
+
+ constexpr const char* COUNTER_NAMES[COUNTER_COUNT] = {
+     "table_hits", "fallbacks", "year_cache_hits", "year_cache_misses",
+     "solver_runs", "solver_steps", "tslong_evaluations",
+ };
+
+ enum Phase {
+     FALLBACK_CONVERSION, // one conversion or month length answered by the astronomical model
+     YEAR_COMPUTE,        // computing one astronomical year on a cache miss
+     PHASE_COUNT
+ };
+
+ constexpr const char* PHASE_NAMES[PHASE_COUNT] = {"fallback", "year_compute"};
+
+ // Bucket i counts durations in [2^i, 2^(i+1)) nanoseconds
+ constexpr int HISTOGRAM_BUCKETS = 32;
+
+ struct Snapshot {
+     std::uint64_t counters[COUNTER_COUNT];
+     std::uint64_t maxSolverSteps; // most days one findSauraMasaStart call tested
+     std::uint64_t histograms[PHASE_COUNT][HISTOGRAM_BUCKETS];
+ };
+
+ // One thread's counts. Only the owning thread writes; relaxed atomics let snapshots read them.
+ struct Block {
+     std::atomic<std::uint64_t> counters[COUNTER_COUNT];
+     std::atomic<std::uint64_t> maxSolverSteps;
+     std::atomic<std::uint64_t> histograms[PHASE_COUNT][HISTOGRAM_BUCKETS];
+     Block* next;
+ };
+
+ inline std::atomic<Block*> blocks{nullptr};
+ inline thread_local Block* threadBlock = nullptr;
+
+ // This thread's block, created and linked in on first use. malloc and placement new keep
+ // libbikram free of C++ runtime dependencies.
+ inline Block& local() {
+     if (!threadBlock) {
+         void* memory = std::calloc(1, sizeof(Block));
+         if (!memory) std::abort();
+         Block* block = new (memory) Block();
+         block->next = blocks.load(std::memory_order_relaxed);
+         while (!blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+         }
+         threadBlock = block;
+     }
+     return *threadBlock;
+ }
+
+ inline void bump(std::atomic<std::uint64_t>& value, std::uint64_t by) {
+     value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+ }
+
+ inline void count(Counter counter, std::uint64_t by = 1) {
+     bump(local().counters[counter], by);
+ }
+
+ inline void solverSteps(std::uint64_t steps) {
+     Block& block = local();
+     bump(block.counters[SOLVER_STEPS], steps);
+     if (steps > block.maxSolverSteps.load(std::memory_order_relaxed)) {
+         block.maxSolverSteps.store(steps, std::memory_order_relaxed);
+     }
+ }
+
+ inline std::uint64_t nowNs() {
+     timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec);
+ }
+
+ // Adds the time since start to a phase histogram. Timing is an explicit start/stop pair
+ // rather than a scope guard: a destructor would give the engine exception cleanup code and
+ // make libbikram depend on the C++ runtime.
+ inline void record(Phase phase, std::uint64_t start) {
+     std::uint64_t ns = nowNs() - start;
+     int bucket = 0;
+     while (bucket + 1 < HISTOGRAM_BUCKETS && (ns >> (bucket + 1)) != 0) ++bucket;
+     bump(local().histograms[phase][bucket], 1);
+ }
+
+ // Sum of every thread's counts so far
+ inline void snapshot(Snapshot& out) {
+     out = Snapshot{};
+     for (Block* block = blocks.load(std::memory_order_acquire); block; block = block->next) {
+         for (int c = 0; c < COUNTER_COUNT; ++c) {
+             out.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+         }
+         std::uint64_t steps = block->maxSolverSteps.load(std::memory_order_relaxed);
+         if (steps > out.maxSolverSteps) out.maxSolverSteps = steps;
+         for (int p = 0; p < PHASE_COUNT; ++p) {
+             for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                 out.histograms[p][b] += block->histograms[p][b].load(std::memory_order_relaxed);
+             }
+         }
+     }
+ }
+
+ // Zero every count. Increments racing with a reset may survive it.
+ inline void reset() {
+     for (Block* block = blocks.load(std::memory_order_acquire); block; block = block->next) {
+         for (auto& counter : block->counters) counter.store(0, std::memory_order_relaxed);
+         block->maxSolverSteps.store(0, std::memory_order_relaxed);
+         for (auto& histogram : block->histograms) {
+             for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+         }
+     }
+ }
+
+ } // namespace bikram_stats
+
+ #ifdef BIKRAM_STATS
+ #define BIKRAM_STATS_ENABLED 1
+ #define BIKRAM_COUNT(counter) bikram_stats::count(bikram_stats::counter)
+ #define BIKRAM_COUNT_N(counter, n) bikram_stats::count(bikram_stats::counter, (n))
+ #define BIKRAM_COUNT_SOLVER_STEPS(n) bikram_stats::solverSteps(n)
+ #define BIKRAM_TIME_START() std::uint64_t bikramStatsStart = bikram_stats::nowNs()
+ #define BIKRAM_TIME_STOP(phase) bikram_stats::record(bikram_stats::phase, bikramStatsStart)
+ // For constexpr functions: count only when running, not during constant evaluation
+ #define BIKRAM_COUNT_AT_RUNTIME(counter) \
+     do { if (!__builtin_is_constant_evaluated()) BIKRAM_COUNT(counter); } while (0)
+ #else
+ #define BIKRAM_STATS_ENABLED 0
+ #define BIKRAM_COUNT(counter) ((void)0)
+ #define BIKRAM_COUNT_N(counter, n) ((void)0)
+ #define BIKRAM_COUNT_SOLVER_STEPS(n) ((void)0)
+ #define BIKRAM_TIME_START() ((void)0)
+ #define BIKRAM_TIME_STOP(phase) ((void)0)
+ #define BIKRAM_COUNT_AT_RUNTIME(counter) ((void)0)
+ #endif
+
+ #endif // BIKRAM_STATS_H
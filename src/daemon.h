@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Conversion daemon for --serve and its client.
+ //
+ // The daemon listens on a UNIX socket and answers one line per request line:
+ //   tobs [--unicode] DATE [FORMAT]           AD -> BS, in the simple format (default y-m-d)
+ //   toad [--unicode] DATE [FORMAT]           BS -> AD
+ //   format [--unicode] bs|ad DATE FORMAT     format a date without converting it
+ //   days YEAR MONTH                          days in a BS month
+ // DATE is written as for --batch (2025-08-30, 2025/8/30). Each answer is "ok RESULT" or
+ // "error MESSAGE". Clients may pipeline any number of requests on one connection.
+
+ #ifndef DAEMON_H
+ #define DAEMON_H
+
+ #include "bikram.h"
+ #include "dateformat.h"
+ #include <cerrno>
+ #include <csignal>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <iostream>
+ #include <map>
+ #include <string>
+ #include <vector>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <sys/stat.h>
+ #include <sys/time.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+
+ // Socket used when no path is given: $XDG_RUNTIME_DIR/nepdate-cli.sock, or a per-user file in /tmp
+ inline std::string defaultSocketPath() {
+     const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+     if (runtime && *runtime) {
+         return std::string(runtime) + "/nepdate-cli.sock";
+     }
+     return "/tmp/nepdate-cli-" + std::to_string(getuid()) + ".sock";
+ }
+
+ // State kept warm between requests: one engine and the formats clients have used
+ class DaemonState {
+ public:
+     // Answer one request line (without its newline), appending the answer line to out
+     void handle(const char* p, const char* end, std::string& out) {
+         if (end > p && end[-1] == '\r') --end;
+         std::string command = nextWord(p, end);
+         bool unicode = false;
+         if (command != "days" && wordIs(p, end, "--unicode")) {
+             nextWord(p, end);
+             unicode = true;
+         }
+
+         if (command == "tobs" || command == "toad") {
+             bool toAd = command == "toad";
+             const char* date = skipSpaces(p, end);
+             const char* dateEnd = wordEnd(date, end);
+             const CompiledFormat& format = compiled(restOf(dateEnd, end, "y-m-d"), unicode, toAd);
+             size_t size = out.size();
+             out += "ok ";
+             if (appendConvertedDate(out, date, dateEnd, format, toAd, bs) != DATE_INPUT_OK) {
+                 out.resize(size);
+                 out += "error invalid date";
+             }
+         } else if (command == "format") {
+             std::string calendar = nextWord(p, end);
+             const char* date = skipSpaces(p, end);
+             const char* dateEnd = wordEnd(date, end);
+             int y, m, d;
+             bool isAd = calendar == "ad";
+             if ((!isAd && calendar != "bs") || readDate(date, dateEnd, isAd, y, m, d) != DATE_INPUT_OK) {
+                 out += "error invalid date";
+             } else {
+                 out += "ok ";
+                 compiled(restOf(dateEnd, end, "y-m-d"), unicode, isAd).appendTo(out, {y, m, d, getDateWeekday(y, m, d, isAd)});
+             }
+         } else if (command == "days") {
+             int y = 0, m = 0;
+             std::string year = nextWord(p, end), month = nextWord(p, end);
+             if (!parseNumber(year, y) || !parseNumber(month, m) || y <= 0 || m < 1 || m > 12 || skipSpaces(p, end) != end) {
+                 out += "error invalid month";
+             } else {
+                 out += "ok " + std::to_string(bs.daysInMonth(y, m));
+             }
+         } else {
+             out += "error unknown command";
+         }
+         out += '\n';
+     }
+
+ private:
+     Bikram bs;
+     std::map<std::string, CompiledFormat> formats;
+
+     // Compiled format for a request, reusing earlier compilations
+     const CompiledFormat& compiled(const std::string& format, bool unicode, bool isToad) {
+         std::string key = std::string(1, static_cast<char>('0' + unicode * 2 + isToad)) + format;
+         auto found = formats.find(key);
+         if (found != formats.end()) return found->second;
+         if (formats.size() >= 256) formats.clear(); // bound memory against clients sending endless formats
+         return formats.emplace(key, CompiledFormat(format, CompiledFormat::SIMPLE, unicode, isToad)).first->second;
+     }
+
+     static const char* skipSpaces(const char* p, const char* end) {
+         while (p < end && (*p == ' ' || *p == '\t')) ++p;
+         return p;
+     }
+
+     static const char* wordEnd(const char* p, const char* end) {
+         while (p < end && *p != ' ' && *p != '\t') ++p;
+         return p;
+     }
+
+     static std::string nextWord(const char*& p, const char* end) {
+         const char* start = skipSpaces(p, end);
+         p = wordEnd(start, end);
+         return std::string(start, p);
+     }
+
+     static bool wordIs(const char* p, const char* end, const char* word) {
+         const char* start = skipSpaces(p, end);
+         return std::string(start, wordEnd(start, end)) == word;
+     }
+
+     // Everything after the separator following p, or fallback when that is empty
+     static std::string restOf(const char* p, const char* end, const char* fallback) {
+         if (p < end) ++p;
+         return p < end ? std::string(p, end) : fallback;
+     }
+
+     static bool parseNumber(const std::string& text, int& value) {
+         if (text.empty() || text.size() > 6 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+         value = std::atoi(text.c_str());
+         return true;
+     }
+ };
+
+ inline volatile std::sig_atomic_t daemonStopRequested = 0;
+
+ inline bool fillSocketAddress(const std::string& path, sockaddr_un& addr) {
+     std::memset(&addr, 0, sizeof addr);
+     addr.sun_family = AF_UNIX;
+     if (path.size() >= sizeof addr.sun_path) {
+         std::cerr << "Error: Socket path too long: " << path << std::endl;
+         return false;
+     }
+     std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+     return true;
+ }
+
+ // Serve requests on a UNIX socket until SIGINT or SIGTERM. A single thread multiplexes every
+ // connection with poll(), so many short-lived clients cost no thread or process creation.
+ inline int runServer(const std::string& path) {
+     sockaddr_un addr;
+     if (!fillSocketAddress(path, addr)) return 1;
+
+     int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+     if (listener < 0) {
+         std::cerr << "Error: Cannot create socket: " << std::strerror(errno) << std::endl;
+         return 1;
+     }
+     // Refuse to replace a live daemon, but clear a socket file left by one that died
+     if (connect(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) {
+         std::cerr << "Error: A daemon is already listening on " << path << std::endl;
+         close(listener);
+         return 1;
+     }
+     close(listener);
+     unlink(path.c_str());
+
+     listener = socket(AF_UNIX, SOCK_STREAM, 0);
+     mode_t mask = umask(077); // only the owner may connect
+     int bound = listener < 0 ? -1 : bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+     umask(mask);
+     if (bound != 0 || listen(listener, SOMAXCONN) != 0) {
+         std::cerr << "Error: Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+         if (listener >= 0) close(listener);
+         return 1;
+     }
+     fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+     struct sigaction stop = {};
+     stop.sa_handler = [](int) { daemonStopRequested = 1; };
+     sigaction(SIGINT, &stop, nullptr);
+     sigaction(SIGTERM, &stop, nullptr);
+     signal(SIGPIPE, SIG_IGN);
+
+     struct Client {
+         int fd;
+         std::string in, out;
+         bool closing = false;
+         bool pending = false; // complete requests left unanswered while out was full
+     };
+     const size_t maxClients = 1024;
+     const size_t maxLine = 4096;
+     // Answers queued for one client. Past this the daemon stops reading and answering its
+     // requests until it reads some, so a client that pipelines without reading cannot grow out.
+     const size_t maxOut = 1 << 20;
+     std::vector<Client> clients;
+     std::vector<pollfd> fds;
+     DaemonState state;
+     char buf[65536];
+
+     while (!daemonStopRequested) {
+         fds.clear();
+         fds.push_back({listener, POLLIN, 0});
+         int timeout = -1;
+         for (const Client& c : clients) {
+             short events = c.closing || c.out.size() >= maxOut ? 0 : POLLIN;
+             if (!c.out.empty()) events |= POLLOUT;
+             if (c.pending && c.out.size() < maxOut) timeout = 0; // room again for held requests
+             fds.push_back({c.fd, events, 0});
+         }
+         if (poll(fds.data(), fds.size(), timeout) < 0) {
+             if (errno == EINTR) continue;
+             std::cerr << "Error: poll failed: " << std::strerror(errno) << std::endl;
+             break;
+         }
+
+         for (size_t i = 0; i < clients.size(); ++i) {
+             Client& c = clients[i];
+             short revents = fds[i + 1].revents;
+             if ((revents & (POLLIN | POLLHUP | POLLERR)) && !c.closing && c.out.size() < maxOut) {
+                 ssize_t n = read(c.fd, buf, sizeof buf);
+                 if (n > 0) {
+                     c.in.append(buf, static_cast<size_t>(n));
+                 } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                     if (!c.in.empty() && c.in.back() != '\n') c.in += '\n'; // answer a final unterminated request
+                     c.closing = true;
+                 }
+             }
+             size_t start = 0;
+             for (size_t nl; c.out.size() < maxOut && (nl = c.in.find('\n', start)) != std::string::npos; start = nl + 1) {
+                 state.handle(c.in.data() + start, c.in.data() + nl, c.out);
+             }
+             c.in.erase(0, start);
+             c.pending = c.in.find('\n') != std::string::npos;
+             if (!c.pending && c.in.size() > maxLine) {
+                 c.out += "error request too long\n";
+                 c.in.clear();
+                 c.closing = true;
+             }
+             if (!c.out.empty()) {
+                 ssize_t n = write(c.fd, c.out.data(), c.out.size());
+                 if (n > 0) {
+                     c.out.erase(0, static_cast<size_t>(n));
+                 } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                     c.out.clear();
+                     c.in.clear();
+                     c.pending = false;
+                     c.closing = true;
+                 }
+             }
+         }
+
+         // Drop finished connections
+         for (size_t i = clients.size(); i-- > 0; ) {
+             if (clients[i].closing && clients[i].out.empty() && !clients[i].pending) {
+                 close(clients[i].fd);
+                 clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+             }
+         }
+
+         if (fds[0].revents & POLLIN) {
+             for (int fd; (fd = accept(listener, nullptr, nullptr)) >= 0; ) {
+                 if (clients.size() >= maxClients) {
+                     close(fd);
+                     continue;
+                 }
+                 fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                 clients.push_back({fd, std::string(), std::string(), false, false});
+             }
+         }
+     }
+
+     for (const Client& c : clients) {
+         close(c.fd);
+     }
+     close(listener);
+     unlink(path.c_str());
+     return 0;
+ }
+
+ // Send one request line to the daemon at path and read its answer line. Returns false when no
+ // daemon answers, so the caller can handle the request in-process instead.
+ inline bool queryDaemon(const std::string& path, const std::string& request, std::string& answer) {
+     sockaddr_un addr;
+     if (!fillSocketAddress(path, addr)) return false;
+     int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+     if (fd < 0) return false;
+     timeval timeout = {2, 0}; // a stuck daemon must not hang scripts
+     setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+     setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+     if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+         close(fd);
+         return false;
+     }
+
+     std::string line = request + '\n';
+     bool ok = send(fd, line.data(), line.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(line.size());
+     answer.clear();
+     char buf[4096];
+     while (ok) {
+         ssize_t n = read(fd, buf, sizeof buf);
+         if (n <= 0) {
+             ok = false;
+             break;
+         }
+         answer.append(buf, static_cast<size_t>(n));
+         size_t nl = answer.find('\n');
+         if (nl != std::string::npos) {
+             answer.resize(nl + 1);
+             break;
+         }
+     }
+     close(fd);
+     return ok;
+ }
+
+ #endif // DAEMON_H
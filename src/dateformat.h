@@ -0,0 +1,525 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Month/weekday names, date parsing and formatting shared by nepdate-cli and its tools.
+
+ #ifndef DATEFORMAT_H
+ #define DATEFORMAT_H
+
+ #include "bikram.h"
+ #include <algorithm>
+ #include <cstring>
+ #include <iostream>
+ #include <string>
+ #include <string_view>
+ #include <vector>
+
+ // Month and weekday data. constexpr views into string literals, so nothing is built before main().
+ inline constexpr std::string_view englishMonths[12] = {
+     "January", "February", "March", "April", "May", "June",
+     "July", "August", "September", "October", "November", "December"
+ };
+ 
+ inline constexpr std::string_view englishMonthsAbbr[12] = {
+     "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+ };
+ 
+ inline constexpr std::string_view englishMonthsDevnagari[12] = {
+     "जनवरी", "फेब्रुअरी", "मार्च", "अप्रिल", "मे", "जुन",
+     "जुलाई", "अगस्ट", "सेप्टेम्बर", "अक्टोबर", "नोभेम्बर", "डिसेम्बर"
+ };
+ 
+ inline constexpr std::string_view romanizedNepaliMonths[12] = {
+     "Baisakh", "Jestha", "Ashadh", "Shrawan", "Bhadra", "Ashwin",
+     "Kartik", "Mangsir", "Poush", "Magh", "Falgun", "Chaitra"
+ };
+ 
+ inline constexpr std::string_view romanizedNepaliMonthsAbbr[12] = {
+     "Bai", "Jes", "Asa", "Shr", "Bha", "Asw", "Kar", "Man", "Pou", "Mag", "Fal", "Cha"
+ };
+ 
+ inline constexpr std::string_view nepaliMonths[12] = {
+     "बैशाख", "जेष्ठ", "आषाढ", "श्रावण", "भाद्रपद", "आश्विन",
+     "कार्तिक", "मङ्सिर", "पौष", "माघ", "फाल्गुन", "चैत्र"
+ };
+ 
+ inline constexpr std::string_view nepaliMonthsAbbr[12] = {
+     "बै.", "जे.", "आ.", "श्रा.", "भा.", "आ.", "का.", "मं.", "पौ.", "मा.", "फा.", "चै."
+ };
+ 
+ inline constexpr std::string_view englishWeekdays[7] = {
+     "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+ };
+ 
+ inline constexpr std::string_view englishWeekdaysAbbr[7] = {
+     "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+ };
+ 
+ inline constexpr std::string_view romanizedNepaliWeekdays[7] = {
+     "Ravivar", "Somvar", "Mangalvar", "Budhvar", "Brihaspativar", "Shukravar", "Shanivar"
+ };
+ 
+ inline constexpr std::string_view romanizedNepaliWeekdaysAbbr[7] = {
+     "Ravi", "Som", "Mangal", "Budh", "Brihas", "Shukra", "Shani"
+ };
+ 
+ inline constexpr std::string_view nepaliWeekdays[7] = {
+     "आइतबार", "सोमबार", "मङ्गलबार", "बुधबार", "बिहीबार", "शुक्रबार", "शनिबार"
+ };
+ 
+ inline constexpr std::string_view nepaliWeekdaysAbbr[7] = {
+     "आइत", "सोम", "मङ्गल", "बुध", "बिही", "शुक्र", "शनि"
+ };
+ 
+ inline constexpr std::string_view englishHalfDays[2] = {"AM", "PM"};
+ 
+ inline constexpr std::string_view nepaliHalfDays[2] = {"पूर्वाह्न", "अपराह्न"};
+ 
+ // Signs the sun enters at each sankranti, starting with Mesh (Baisakh)
+ inline constexpr std::string_view romanizedRashis[12] = {
+     "Mesh", "Brish", "Mithun", "Karkat", "Simha", "Kanya",
+     "Tula", "Brishchik", "Dhanu", "Makar", "Kumbha", "Meen"
+ };
+ 
+ inline constexpr std::string_view nepaliRashis[12] = {
+     "मेष", "वृष", "मिथुन", "कर्कट", "सिंह", "कन्या",
+     "तुला", "वृश्चिक", "धनु", "मकर", "कुम्भ", "मीन"
+ };
+ 
+ // Get weekday from Gregorian (0 = Sunday). Pure arithmetic, so it stays cheap in batch mode,
+ // and correct for years <= 0 because the day number is reduced with a floored modulo.
+ inline int getWeekday(int year, int month, int day) {
+     long dow = (Bikram::toJulianDay(year, month, day) + 1) % 7;
+     return static_cast<int>(dow < 0 ? dow + 7 : dow);
+ }
+ 
+ 
+ // Name tables used by each specifier: 12 month names or 7 weekday names
+ inline const std::string_view* monthNames(bool unicode, bool isToad) {
+     if (isToad) {
+         return unicode ? englishMonthsDevnagari : englishMonths;
+     }
+     return unicode ? nepaliMonths : romanizedNepaliMonths;
+ }
+ 
+ inline const std::string_view* monthNamesAbbr(bool unicode, bool isToad) {
+     if (isToad) {
+         return englishMonthsAbbr;
+     }
+     return unicode ? nepaliMonthsAbbr : romanizedNepaliMonthsAbbr;
+ }
+ 
+ inline const std::string_view* weekdayNames(bool unicode, bool isToad) {
+     if (!unicode) {
+        return isToad ? englishWeekdays : romanizedNepaliWeekdays;
+     }
+     return nepaliWeekdays;
+ }
+ 
+ inline const std::string_view* weekdayNamesAbbr(bool unicode, bool isToad) {
+     if (!unicode) {
+        return isToad ? englishWeekdaysAbbr : romanizedNepaliWeekdaysAbbr;
+     }
+     return nepaliWeekdaysAbbr;
+ }
+ 
+ // UTF-8 bytes of the Devanagari digits ० to ९
+ constexpr char DEVANAGARI_DIGITS[10][4] = {"०", "१", "२", "३", "४", "५", "६", "७", "८", "९"};
+ 
+ // Terminal columns taken by UTF-8 text, counted as wcwidth() does: Devanagari nonspacing
+ // marks (most vowel signs, virama, nukta, candrabindu, anusvara) take none, everything else one.
+ inline int displayWidth(std::string_view text) {
+     int width = 0;
+     for (size_t i = 0; i < text.size();) {
+         unsigned char c = static_cast<unsigned char>(text[i]);
+         size_t length = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+         if (length == 3 && i + 2 < text.size()) {
+             unsigned cp = ((c & 0x0Fu) << 12) | ((text[i + 1] & 0x3Fu) << 6) | (text[i + 2] & 0x3Fu);
+             bool nonspacing = cp <= 0x0902 ? cp >= 0x0900
+                             : cp == 0x093A || cp == 0x093C || (cp >= 0x0941 && cp <= 0x0948) || cp == 0x094D ||
+                               (cp >= 0x0951 && cp <= 0x0957) || cp == 0x0962 || cp == 0x0963;
+             if (!nonspacing) ++width;
+         } else {
+             ++width;
+         }
+         i += length;
+     }
+     return width;
+ }
+ 
+ // Append text right-aligned in a field of width columns
+ inline void appendAligned(std::string& out, std::string_view text, int width) {
+     for (int pad = width - displayWidth(text); pad > 0; --pad) out += ' ';
+     out += text;
+ }
+ 
+ // Append a non-negative number right-aligned in width columns, in Devanagari digits if unicode
+ inline void appendNumber(std::string& out, int value, int width, bool unicode) {
+     char digits[12];
+     int count = 0;
+     do {
+         digits[count++] = static_cast<char>('0' + value % 10);
+         value /= 10;
+     } while (value > 0 && count < 12);
+     for (int pad = width - count; pad > 0; --pad) out += ' ';
+     while (count > 0) {
+         char digit = digits[--count];
+         if (unicode) {
+             out.append(DEVANAGARI_DIGITS[digit - '0'], 3);
+         } else {
+             out += digit;
+         }
+     }
+ }
+ 
+ // Values a compiled format can render
+ struct DateTimeFields {
+     int year, month, day;
+     int weekday; // 0 = Sunday
+     int hour = 0, minute = 0, second = 0;
+ };
+ 
+ // A --format string parsed once into a list of literal and field ops. Rendering walks the
+ // ops and copies precomputed UTF-8 bytes into a caller-supplied buffer, so converting
+ // millions of dates neither re-scans the format nor allocates.
+ class CompiledFormat {
+ public:
+     enum Syntax { SIMPLE, STRFTIME };
+ 
+     // SIMPLE takes the y,m,d,M,w,W specifiers of --today/--tobs/--toad/--batch/--csv,
+     // STRFTIME the %-specifiers of --now.
+     CompiledFormat(std::string_view format, Syntax syntax, bool unicode, bool isToad) : unicode(unicode) {
+         ops.reserve(format.size());
+         literals.reserve(format.size());
+         if (syntax == SIMPLE) {
+             compileSimple(format, isToad);
+         } else {
+             compileStrftime(format, isToad);
+         }
+     }
+ 
+     // Upper bound on the bytes render() writes for any date
+     size_t maxLength() const { return maxLen; }
+ 
+     // Render into buf, writing at most cap bytes (no terminator). Returns the bytes written.
+     size_t render(char* buf, size_t cap, const DateTimeFields& t) const {
+         char* out = buf;
+         char* end = buf + cap;
+         for (const Op& op : ops) {
+             switch (op.kind) {
+                 case LITERAL:
+                     out = put(out, end, literals.data() + op.offset, op.length);
+                     break;
+                 case NUMBER:
+                     out = putNumber(out, end, fieldValue(op.field, t), op.pad);
+                     break;
+                 case NAME: {
+                     std::string_view name = op.names[fieldValue(op.field, t)];
+                     out = put(out, end, name.data(), name.size());
+                     break;
+                 }
+             }
+         }
+         return out - buf;
+     }
+ 
+     // Append the rendering to out, reusing its spare capacity
+     void appendTo(std::string& out, const DateTimeFields& t) const {
+         size_t size = out.size();
+         out.resize(size + maxLen);
+         out.resize(size + render(&out[size], maxLen, t));
+     }
+ 
+ private:
+     enum Kind : unsigned char { LITERAL, NUMBER, NAME };
+     enum Field : unsigned char { YEAR, YEAR_SHORT, MONTH, MONTH_INDEX, DAY, WEEKDAY, HOUR, HOUR12, HALF_DAY, MINUTE, SECOND };
+ 
+     struct Op {
+         Kind kind;
+         Field field;
+         bool pad;                              // NUMBER: zero-pad to two digits
+         unsigned offset, length;               // LITERAL: slice of literals
+         const std::string_view* names;         // NAME: table indexed by field
+     };
+ 
+     bool unicode;
+     std::vector<Op> ops;
+     std::string literals;
+     size_t maxLen = 0;
+ 
+     void addLiteral(const char* text, size_t length) {
+         if (!ops.empty() && ops.back().kind == LITERAL) {
+             ops.back().length += static_cast<unsigned>(length);
+         } else {
+             ops.push_back({LITERAL, YEAR, false, static_cast<unsigned>(literals.size()), static_cast<unsigned>(length), nullptr});
+         }
+         literals.append(text, length);
+         maxLen += length;
+     }
+ 
+     void addNumber(Field field, bool pad) {
+         ops.push_back({NUMBER, field, pad, 0, 0, nullptr});
+         maxLen += 1 + 10 * (unicode ? 3 : 1); // sign and digits of any int
+     }
+ 
+     void addName(Field field, const std::string_view* names, size_t count) {
+         ops.push_back({NAME, field, false, 0, 0, names});
+         size_t longest = 0;
+         for (size_t i = 0; i < count; ++i) longest = std::max(longest, names[i].size());
+         maxLen += longest;
+     }
+ 
+     void compileSimple(std::string_view format, bool isToad) {
+         for (char c : format) {
+             switch (c) {
+                 case 'y': addNumber(YEAR, false); break;
+                 case 'm': addNumber(MONTH, false); break;
+                 case 'd': addNumber(DAY, false); break;
+                 case 'M': addName(MONTH_INDEX, monthNames(unicode, isToad), 12); break;
+                 case 'w': addName(WEEKDAY, weekdayNames(unicode, false), 7); break; // NP
+                 case 'W': addName(WEEKDAY, weekdayNames(unicode, true), 7); break; // EN
+                 default: addLiteral(&c, 1);
+             }
+         }
+     }
+ 
+     void compileStrftime(std::string_view format, bool isToad) {
+         for (size_t i = 0; i < format.length(); ++i) {
+             if (format[i] != '%' || i + 1 == format.length()) {
+                 addLiteral(&format[i], 1);
+                 continue;
+             }
+             switch (format[++i]) {
+                 case 'Y': addNumber(YEAR, false); break;
+                 case 'y': addNumber(YEAR_SHORT, true); break;
+                 case 'm': addNumber(MONTH, true); break;
+                 case 'B': addName(MONTH_INDEX, monthNames(unicode, isToad), 12); break;
+                 case 'b': addName(MONTH_INDEX, monthNamesAbbr(unicode, isToad), 12); break;
+                 case 'd': addNumber(DAY, true); break;
+                 case 'A': addName(WEEKDAY, weekdayNames(unicode, isToad), 7); break;
+                 case 'a': addName(WEEKDAY, weekdayNamesAbbr(unicode, isToad), 7); break;
+                 case 'H': addNumber(HOUR, true); break;
+                 case 'I': addNumber(HOUR12, true); break;
+                 case 'M': addNumber(MINUTE, true); break;
+                 case 'S': addNumber(SECOND, true); break;
+                 case 'p': addName(HALF_DAY, unicode ? nepaliHalfDays : englishHalfDays, 2); break;
+                 case 'c': compileStrftime("%a %b %d %H:%M:%S %Y", isToad); break;
+                 case 'x': compileStrftime("%m/%d/%y", isToad); break;
+                 case 'X': compileStrftime("%H:%M:%S", isToad); break;
+                 case '%': addLiteral("%", 1); break;
+                 default: addLiteral(&format[i - 1], 2); break;
+             }
+         }
+     }
+ 
+     static int fieldValue(Field field, const DateTimeFields& t) {
+         switch (field) {
+             case YEAR: return t.year;
+             case YEAR_SHORT: return t.year % 100;
+             case MONTH: return t.month;
+             case MONTH_INDEX: return t.month - 1;
+             case DAY: return t.day;
+             case WEEKDAY: return t.weekday;
+             case HOUR: return t.hour;
+             case HOUR12: return (t.hour == 0 || t.hour == 12) ? 12 : t.hour % 12;
+             case HALF_DAY: return t.hour < 12 ? 0 : 1;
+             case MINUTE: return t.minute;
+             case SECOND: return t.second;
+         }
+         return 0;
+     }
+ 
+     static char* put(char* out, char* end, const char* text, size_t length) {
+         length = std::min(length, static_cast<size_t>(end - out));
+         std::memcpy(out, text, length);
+         return out + length;
+     }
+ 
+     char* putNumber(char* out, char* end, int value, bool pad) const {
+         char digits[12];
+         char* p = digits + sizeof digits;
+         unsigned v = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+         do {
+             *--p = static_cast<char>('0' + v % 10);
+             v /= 10;
+         } while (v);
+         if (pad && value >= 0 && value < 10) *--p = '0';
+         if (value < 0) *--p = '-';
+         if (!unicode) {
+             return put(out, end, p, digits + sizeof digits - p);
+         }
+         for (; p < digits + sizeof digits; ++p) {
+             if (*p == '-') {
+                 out = put(out, end, p, 1);
+             } else {
+                 out = put(out, end, DEVANAGARI_DIGITS[*p - '0'], 3);
+             }
+         }
+         return out;
+     }
+ };
+ 
+ // Weekday (0 = Sunday) of an AD date, or of a BS date when isToad is false
+ inline int getDateWeekday(int y, int m, int d, bool isToad) {
+     if (isToad) {
+         return getWeekday(y, m, d);
+     }
+     Bikram bs;
+     int gy, gm, gd;
+     bs.toGregorian(y, m, d, gy, gm, gd);
+     return getWeekday(gy, gm, gd);
+ }
+ 
+ // Why a date input was rejected
+ enum DateInputError {
+     DATE_INPUT_OK,
+     DATE_INPUT_EMPTY,  // nothing but blanks
+     DATE_INPUT_SYNTAX, // not three numbers
+     DATE_INPUT_YEAR,   // year 0
+     DATE_INPUT_MONTH,  // month outside 1-12
+     DATE_INPUT_DAY,    // day outside the month
+ };
+
+ inline const char* dateInputMessage(DateInputError error) {
+     switch (error) {
+         case DATE_INPUT_OK: return "ok";
+         case DATE_INPUT_EMPTY: return "no date";
+         case DATE_INPUT_SYNTAX: return "expected year, month and day";
+         case DATE_INPUT_YEAR: return "year out of range";
+         case DATE_INPUT_MONTH: return "month out of range";
+         case DATE_INPUT_DAY: return "day out of range";
+     }
+     return "invalid date";
+ }
+
+ // Read one date field of up to six ASCII digits, or Devanagari digits (U+0966-U+096F,
+ // UTF-8 E0 A5 A6-AF), and advance p past it
+ inline bool readDateField(const char*& p, const char* end, int& value) {
+     int digits = 0;
+     value = 0;
+     if (*p == '\xE0') {
+         while (end - p >= 3 && p[0] == '\xE0' && p[1] == '\xA5' && p[2] >= '\xA6' && p[2] <= '\xAF') {
+             if (++digits > 6) return false;
+             value = value * 10 + (p[2] - '\xA6');
+             p += 3;
+         }
+     } else {
+         while (p < end && *p >= '0' && *p <= '9') {
+             if (++digits > 6) return false;
+             value = value * 10 + (*p++ - '0');
+         }
+     }
+     return digits > 0;
+ }
+
+ // Parse year, month and day from a line such as "2025 8 30", "2025-08-30", "2025/8/30" or
+ // "२०८२-०५-१४". Returns false for anything that is not exactly three numeric fields.
+ // Never throws or allocates; "YYYY-MM-DD" and "YYYY/MM/DD" take a fixed-width fast path.
+ inline bool parseDateFields(const char* p, const char* end, int& y, int& m, int& d) {
+     auto digit = [](char c) { return static_cast<unsigned>(c - '0') < 10; };
+     const char* last = end > p && end[-1] == '\r' ? end - 1 : end;
+     if (last - p == 10 && (p[4] == '-' || p[4] == '/') && p[7] == p[4] && digit(p[0]) && digit(p[1]) &&
+         digit(p[2]) && digit(p[3]) && digit(p[5]) && digit(p[6]) && digit(p[8]) && digit(p[9])) {
+         y = (p[0] - '0') * 1000 + (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+         m = (p[5] - '0') * 10 + (p[6] - '0');
+         d = (p[8] - '0') * 10 + (p[9] - '0');
+         return true;
+     }
+
+     int fields[3];
+     int count = 0;
+     while (p < end && (*p == ' ' || *p == '\t')) ++p;
+     while (p < end && count < 3) {
+         if (!readDateField(p, end, fields[count++])) return false;
+         if (count < 3) {
+             const char* sep = p;
+             while (p < end && (*p == ' ' || *p == '\t' || *p == '-' || *p == '/' || *p == '.' || *p == ',')) ++p;
+             if (p == sep) return false;
+         }
+     }
+     while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+     if (count != 3 || p != end) return false;
+     y = fields[0];
+     m = fields[1];
+     d = fields[2];
+     return true;
+ }
+
+ // Check a parsed date against the BS calendar, or the Gregorian one when isAd is set
+ inline DateInputError checkDate(bool isAd, int y, int m, int d) {
+     if (y <= 0) return DATE_INPUT_YEAR;
+     if (m < 1 || m > 12) return DATE_INPUT_MONTH;
+     if (d < 1 || d > (isAd ? Bikram::gregorianDaysInMonth(y, m) : Bikram::daysInMonth(y, m))) return DATE_INPUT_DAY;
+     return DATE_INPUT_OK;
+ }
+
+ // Parse a date with parseDateFields and check it with checkDate
+ inline DateInputError readDate(const char* p, const char* end, bool isAd, int& y, int& m, int& d) {
+     if (!parseDateFields(p, end, y, m, d)) {
+         while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+         return p == end ? DATE_INPUT_EMPTY : DATE_INPUT_SYNTAX;
+     }
+     return checkDate(isAd, y, m, d);
+ }
+
+ // Convert the date in [p, end) (AD to BS, or BS to AD when toAd is set) and append it to out
+ // using the compiled simple format. If the text is not a valid date, appends nothing and
+ // returns why.
+ inline DateInputError appendConvertedDate(std::string& out, const char* p, const char* end, const CompiledFormat& format,
+                                           bool toAd, Bikram& bs) {
+     int y, m, d;
+     DateInputError error = readDate(p, end, !toAd, y, m, d);
+     if (error != DATE_INPUT_OK) return error;
+     if (toAd) {
+         int gy, gm, gd;
+         bs.toGregorian(y, m, d, gy, gm, gd);
+         format.appendTo(out, {gy, gm, gd, getWeekday(gy, gm, gd)});
+     } else {
+         bs.fromGregorian(y, m, d);
+         format.appendTo(out, {bs.getYear(), bs.getMonth(), bs.getDay(), getWeekday(y, m, d)});
+     }
+     return DATE_INPUT_OK;
+ }
+ 
+ // Print one rendering followed by a newline
+ inline void printFormatted(const CompiledFormat& format, const DateTimeFields& t) {
+     char stackBuf[256];
+     std::vector<char> heapBuf;
+     char* buf = stackBuf;
+     if (format.maxLength() + 1 > sizeof stackBuf) {
+         heapBuf.resize(format.maxLength() + 1);
+         buf = heapBuf.data();
+     }
+     size_t n = format.render(buf, format.maxLength(), t);
+     buf[n++] = '\n';
+     std::cout.write(buf, n);
+     std::cout.flush();
+ }
+ 
+ // Print formatted date using simple specifiers (y,m,d,M,w,W)
+ inline void displayFormattedDate(int y, int m, int d, std::string_view format, bool unicode, bool isToad) {
+     CompiledFormat compiled(format, CompiledFormat::SIMPLE, unicode, isToad);
+     printFormatted(compiled, {y, m, d, getDateWeekday(y, m, d, isToad)});
+ }
+ 
+ // Print formatted date/time using strftime-style specifiers
+ inline void displayStrfFormattedDateTime(int y, int m, int d, int h, int min, int s, std::string_view format, bool unicode, bool isToad) {
+     CompiledFormat compiled(format, CompiledFormat::STRFTIME, unicode, isToad);
+     printFormatted(compiled, {y, m, d, getDateWeekday(y, m, d, isToad), h, min, s});
+ }
+ 
+ #endif // DATEFORMAT_H
@@ -15,74 +15,30 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
  #include "bikram.h"
+ #include "dateformat.h"
+ #include "daemon.h"
+ #include "bikram_events.h"
+ #include "recordwriter.h"
  #include <iostream>
  #include <string>
- #include <map>
+ #include <string_view>
+ #include <optional>
  #include <ctime>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <cerrno>
+ #include <cstdint>
  #include <vector>
- 
- // Devanagari digit mapping
- std::map<char, std::string> devanagariNumbers = {
-     {'0', "०"}, {'1', "१"}, {'2', "२"}, {'3', "३"}, {'4', "४"},
-     {'5', "५"}, {'6', "६"}, {'7', "७"}, {'8', "८"}, {'9', "९"}
- };
- 
- // Month and weekday data
- std::vector<std::string> englishMonths = {
-     "January", "February", "March", "April", "May", "June",
-     "July", "August", "September", "October", "November", "December"
- };
- 
- std::vector<std::string> englishMonthsAbbr = {
-     "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
- };
- 
- std::vector<std::string> englishMonthsDevnagari = {
-     "जनवरी", "फेब्रुअरी", "मार्च", "अप्रिल", "मे", "जुन",
-     "जुलाई", "अगस्ट", "सेप्टेम्बर", "अक्टोबर", "नोभेम्बर", "डिसेम्बर"
- };
- 
- std::vector<std::string> romanizedNepaliMonths = {
-     "Baisakh", "Jestha", "Ashadh", "Shrawan", "Bhadra", "Ashwin",
-     "Kartik", "Mangsir", "Poush", "Magh", "Falgun", "Chaitra"
- };
- 
- std::vector<std::string> romanizedNepaliMonthsAbbr = {
-     "Bai", "Jes", "Asa", "Shr", "Bha", "Asw", "Kar", "Man", "Pou", "Mag", "Fal", "Cha"
- };
- 
- std::vector<std::string> nepaliMonths = {
-     "बैशाख", "जेष्ठ", "आषाढ", "श्रावण", "भाद्रपद", "आश्विन",
-     "कार्तिक", "मङ्सिर", "पौष", "माघ", "फाल्गुन", "चैत्र"
- };
- 
- std::vector<std::string> nepaliMonthsAbbr = {
-     "बै.", "जे.", "आ.", "श्रा.", "भा.", "आ.", "का.", "मं.", "पौ.", "मा.", "फा.", "चै."
- };
- 
- std::vector<std::string> englishWeekdays = {
-     "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
- };
- 
- std::vector<std::string> englishWeekdaysAbbr = {
-     "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
- };
- 
- std::vector<std::string> romanizedNepaliWeekdays = {
-     "Ravivar", "Somvar", "Mangalvar", "Budhvar", "Brihaspativar", "Shukravar", "Shanivar"
- };
- 
- std::vector<std::string> romanizedNepaliWeekdaysAbbr = {
-     "Ravi", "Som", "Mangal", "Budh", "Brihas", "Shukra", "Shani"
- };
- 
- std::vector<std::string> nepaliWeekdays = {
-     "आइतबार", "सोमबार", "मङ्गलबार", "बुधबार", "बिहीबार", "शुक्रबार", "शनिबार"
- };
- 
- std::vector<std::string> nepaliWeekdaysAbbr = {
-     "आइत", "सोम", "मङ्गल", "बुध", "बिही", "शुक्र", "शनि"
- };
+ #include <algorithm>
+ #include <thread>
+ #include <system_error>
+ #include <mutex>
+ #include <condition_variable>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
  
  // Get current date
  void getCurrentDate(int &year, int &month, int &day) {
@@ -105,157 +61,6 @@
      second = now->tm_sec;
  }
  
- // Get weekday from Gregorian
- int getWeekday(int year, int month, int day) {
-     std::tm t = {};
-     t.tm_year = year - 1900;
-     t.tm_mon = month - 1;
-     t.tm_mday = day;
-     std::mktime(&t);
-     return t.tm_wday;
- }
- 
- // Convert digits
- std::string convertToDevanagari(int num) {
-     std::string result, s = std::to_string(num);
-     for (char c : s) result += devanagariNumbers.count(c) ? devanagariNumbers[c] : std::string(1, c);
-     return result;
- }
- 
- // Get month name
- std::string getMonthName(int month, bool unicode, bool isToad) {
-     if (isToad) {
-         return unicode ? englishMonthsDevnagari[month - 1] : englishMonths[month - 1];
-     }
-     return unicode ? nepaliMonths[month - 1] : romanizedNepaliMonths[month - 1];
- }
- 
- std::string getMonthNameAbbr(int month, bool unicode, bool isToad) {
-     if (isToad) {
-         return englishMonthsAbbr[month - 1];
-     }
-     return unicode ? nepaliMonthsAbbr[month - 1] : romanizedNepaliMonthsAbbr[month - 1];
- }
- 
- // Get weekday name
- std::string getWeekdayName(int dow, bool unicode, bool isToad) {
-     if (!unicode) {
-        return isToad ? englishWeekdays[dow] : romanizedNepaliWeekdays[dow];
-     }
-     return nepaliWeekdays[dow];
- }
- 
- std::string getWeekdayNameAbbr(int dow, bool unicode, bool isToad) {
-     if (!unicode) {
-        return isToad ? englishWeekdaysAbbr[dow] : romanizedNepaliWeekdaysAbbr[dow];
-     }
-     return nepaliWeekdaysAbbr[dow];
- }
- 
- // Print formatted date using simple specifiers (y,m,d,M,w,W)
- void displayFormattedDate(int y, int m, int d, const std::string& format, bool unicode, bool isToad) {
-     std::string out;
-     auto num = [unicode](int x) { return unicode ? convertToDevanagari(x) : std::to_string(x); };
- 
-     int dow;
-     if (isToad) {
-         dow = getWeekday(y, m, d);
-     } else {
-         Bikram bs;
-         int gy, gm, gd;
-         bs.toGregorian(y, m, d, gy, gm, gd);
-         dow = getWeekday(gy, gm, gd);
-     }
- 
-     for (size_t i = 0; i < format.length(); ++i) {
-         switch (format[i]) {
-             case 'y': out += num(y); break;
-             case 'm': out += num(m); break;
-             case 'd': out += num(d); break;
-             case 'M': out += getMonthName(m, unicode, isToad); break;
-             case 'w': out += getWeekdayName(dow, unicode, false); break; // NP
-             case 'W': out += getWeekdayName(dow, unicode, true); break; // EN
-             default: out += format[i];
-         }
-     }
-     std::cout << out << std::endl;
- }
- 
- // Print formatted date/time using strftime-style specifiers
- void displayStrfFormattedDateTime(int y, int m, int d, int h, int min, int s, const std::string& format, bool unicode, bool isToad) {
-     std::string out;
-     auto num = [unicode](int x) { return unicode ? convertToDevanagari(x) : std::to_string(x); };
-     auto paddedNum = [unicode](int num_to_pad) {
-         std::string s = std::to_string(num_to_pad);
-         if (num_to_pad < 10) {
-             s = "0" + s;
-         }
-         if (unicode) {
-             std::string result;
-             for (char c : s) {
-                 result += devanagariNumbers.at(c);
-             }
-             return result;
-         }
-         return s;
-     };
- 
-     int dow;
-     if (isToad) {
-         dow = getWeekday(y, m, d);
-     } else {
-         Bikram bs;
-         int gy, gm, gd;
-         bs.toGregorian(y, m, d, gy, gm, gd);
-         dow = getWeekday(gy, gm, gd);
-     }
- 
-     for (size_t i = 0; i < format.length(); ++i) {
-         if (format[i] == '%' && i + 1 < format.length()) {
-            i++; // consume '%'
-            switch (format[i]) {
-                case 'Y': out += num(y); break;
-                case 'y': out += paddedNum(y % 100); break;
-                case 'm': out += paddedNum(m); break;
-                case 'B': out += getMonthName(m, unicode, isToad); break;
-                case 'b': out += getMonthNameAbbr(m, unicode, isToad); break;
-                case 'd': out += paddedNum(d); break;
-                case 'A': out += getWeekdayName(dow, unicode, isToad); break;
-                case 'a': out += getWeekdayNameAbbr(dow, unicode, isToad); break;
-                case 'H': out += paddedNum(h); break;
-                case 'I': out += paddedNum((h == 0 || h == 12) ? 12 : h % 12); break;
-                case 'M': out += paddedNum(min); break;
-                case 'S': out += paddedNum(s); break;
-                case 'p':
-                    if (unicode) {
-                        out += (h < 12) ? "पूर्वाह्न" : "अपराह्न";
-                    } else {
-                        out += (h < 12) ? "AM" : "PM";
-                    }
-                    break;
-                case 'c':
-                    out += getWeekdayNameAbbr(dow, unicode, isToad) + " ";
-                    out += getMonthNameAbbr(m, unicode, isToad) + " ";
-                    out += paddedNum(d) + " ";
-                    out += paddedNum(h) + ":" + paddedNum(min) + ":" + paddedNum(s) + " ";
-                    out += num(y);
-                    break;
-                case 'x':
-                    out += paddedNum(m) + "/" + paddedNum(d) + "/" + paddedNum(y % 100);
-                    break;
-                case 'X':
-                    out += paddedNum(h) + ":" + paddedNum(min) + ":" + paddedNum(s);
-                    break;
-                case '%': out += '%'; break;
-                default: out += '%' + std::string(1, format[i]); break;
-            }
-         } else {
-             out += format[i];
-         }
-     }
-     std::cout << out << std::endl;
- }
- 
  // Shows a detailed summary of today's date. Called when no arguments are given.
  void showDefaultDateSummary() {
      int gy, gm, gd;
@@ -280,7 +85,7 @@
  }
  
  // Shows today's date using the simple format.
- void showFormattedToday(const std::string& format, bool unicode, bool showAd) {
+ void showFormattedToday(std::string_view format, bool unicode, bool showAd) {
      int gy, gm, gd;
      getCurrentDate(gy, gm, gd);
  
@@ -294,7 +99,7 @@
  }
  
  // Shows current date and time using strftime format.
- void showFormattedNow(const std::string& format, bool unicode, bool showAd) {
+ void showFormattedNow(std::string_view format, bool unicode, bool showAd) {
      int gy, gm, gd, h, min, s;
      getCurrentDateTime(gy, gm, gd, h, min, s);
  
@@ -307,19 +112,783 @@
      }
  }
  
+ // Print the current date and time every interval seconds until interrupted, rewriting one
+ // line on a terminal and writing one line per tick otherwise. The format is compiled once and
+ // the date fields (BS conversion and weekday) are only recomputed when the local date rolls
+ // over; other ticks just derive the time of day from the seconds since local midnight.
+ int watchNow(std::string_view format, bool unicode, bool showAd, long interval) {
+     const CompiledFormat compiled(format, CompiledFormat::STRFTIME, unicode, showAd);
+     std::vector<char> line(compiled.maxLength() + 8);
+     const bool inPlace = isatty(STDOUT_FILENO);
+     DateTimeFields fields{0, 1, 1, 0};
+     time_t dayStart = 0, nextDay = 0; // local midnight of the shown date and of the next one
+     bool uniformDay = false;          // no UTC offset change in between, so t - dayStart is the time of day
+
+     for (;;) {
+         timespec now;
+         clock_gettime(CLOCK_REALTIME, &now);
+         time_t t = now.tv_sec;
+         if (t < dayStart || t >= nextDay) {
+             struct tm local;
+             localtime_r(&t, &local);
+             int gy = local.tm_year + 1900, gm = local.tm_mon + 1, gd = local.tm_mday;
+             if (showAd) {
+                 fields = {gy, gm, gd, local.tm_wday};
+             } else {
+                 BsDate bs = Bikram::toBs({gy, gm, gd});
+                 fields = {bs.year, bs.month, bs.day, local.tm_wday};
+             }
+             struct tm start = local, next = local;
+             start.tm_hour = start.tm_min = start.tm_sec = next.tm_hour = next.tm_min = next.tm_sec = 0;
+             start.tm_isdst = next.tm_isdst = -1;
+             ++next.tm_mday;
+             dayStart = mktime(&start);
+             nextDay = mktime(&next);
+             uniformDay = nextDay - dayStart == 86400 && start.tm_hour == 0 && next.tm_hour == 0 &&
+                          start.tm_gmtoff == next.tm_gmtoff;
+             if (dayStart > t) dayStart = t; // midnight skipped by a clock change
+         }
+         if (uniformDay) {
+             long seconds = static_cast<long>(t - dayStart);
+             fields.hour = static_cast<int>(seconds / 3600);
+             fields.minute = static_cast<int>(seconds / 60 % 60);
+             fields.second = static_cast<int>(seconds % 60);
+         } else {
+             // A daylight-saving change today: ask the C library every tick
+             struct tm local;
+             localtime_r(&t, &local);
+             fields.hour = local.tm_hour;
+             fields.minute = local.tm_min;
+             fields.second = local.tm_sec;
+         }
+
+         char* out = line.data();
+         size_t n = 0;
+         if (inPlace) out[n++] = '\r';
+         n += compiled.render(out + n, compiled.maxLength(), fields);
+         if (inPlace) {
+             std::memcpy(out + n, "\e[K", 3); // clear what a longer previous line left behind
+             n += 3;
+         } else {
+             out[n++] = '\n';
+         }
+         if (std::fwrite(out, 1, n, stdout) != n || std::fflush(stdout) != 0) return 1;
+
+         // Sleep to the next multiple of interval, so ticks land just after the second changes
+         timespec wake = {static_cast<time_t>((now.tv_sec / interval + 1) * interval), 0};
+         while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &wake, nullptr) == EINTR) {
+         }
+     }
+ }
+ 
+ // First day of the month a calendar grid is about to render
+ struct CalendarCursor {
+     int bsYear, bsMonth;
+     int weekday; // 0 = Sunday
+     int adYear, adMonth, adDay;
+ };
+ 
+ // Move an AD date forward by days without a full date conversion
+ void advanceAdDate(int& year, int& month, int& day, int days) {
+     day += days;
+     for (int length; day > (length = Bikram::gregorianDaysInMonth(year, month)); ) {
+         day -= length;
+         if (++month > 12) {
+             month = 1;
+             ++year;
+         }
+     }
+ }
+ 
+ // Append the grid of the BS month at cursor to out and move the cursor to the next month.
+ // Days, weekdays and AD dates are counted forward from the cursor, so rendering needs no
+ // conversions of its own. With showAd every cell also shows the AD day of the month.
+ void appendMonthGrid(std::string& out, CalendarCursor& cursor, int length, bool unicode, bool showAd) {
+     std::string_view headers[7];
+     int cellWidth = showAd ? 5 : 2;
+     for (int i = 0; i < 7; ++i) {
+         headers[i] = unicode ? nepaliWeekdaysAbbr[i] : englishWeekdaysAbbr[i].substr(0, 2);
+         cellWidth = std::max(cellWidth, displayWidth(headers[i]));
+     }
+     const int rowWidth = 7 * cellWidth + 6;
+ 
+     // Title, e.g. "Bhadra 2082 (Aug/Sep 2025)"
+     std::string title((unicode ? nepaliMonths : romanizedNepaliMonths)[cursor.bsMonth - 1]);
+     title += ' ';
+     appendNumber(title, cursor.bsYear, 0, unicode);
+     if (showAd) {
+         int lastYear = cursor.adYear, lastMonth = cursor.adMonth, lastDay = cursor.adDay;
+         advanceAdDate(lastYear, lastMonth, lastDay, length - 1);
+         const std::string_view* adMonths = unicode ? englishMonthsDevnagari : englishMonthsAbbr;
+         title += " (";
+         title += adMonths[cursor.adMonth - 1];
+         if (lastYear != cursor.adYear) {
+             title += " ";
+             appendNumber(title, cursor.adYear, 0, unicode);
+         }
+         if (lastMonth != cursor.adMonth) {
+             title += '/';
+             title += adMonths[lastMonth - 1];
+         }
+         title += " ";
+         appendNumber(title, lastYear, 0, unicode);
+         title += ")";
+     }
+     appendAligned(out, title, (rowWidth + displayWidth(title)) / 2);
+     out += '\n';
+ 
+     for (int i = 0; i < 7; ++i) {
+         if (i > 0) out += ' ';
+         appendAligned(out, headers[i], cellWidth);
+     }
+     out += '\n';
+ 
+     int column = cursor.weekday;
+     if (column > 0) out.append(static_cast<size_t>(column * (cellWidth + 1) - 1), ' ');
+     for (int day = 1; day <= length; ++day) {
+         if (column > 0) out += ' ';
+         if (showAd) {
+             appendNumber(out, day, cellWidth - 3, unicode);
+             out += ' ';
+             appendNumber(out, cursor.adDay, 2, unicode);
+             advanceAdDate(cursor.adYear, cursor.adMonth, cursor.adDay, 1);
+         } else {
+             appendNumber(out, day, cellWidth, unicode);
+         }
+         if (++column == 7 || day == length) {
+             out += '\n';
+             column = 0;
+         }
+     }
+ 
+     cursor.weekday = (cursor.weekday + length) % 7;
+     if (!showAd) advanceAdDate(cursor.adYear, cursor.adMonth, cursor.adDay, length);
+     if (++cursor.bsMonth > 12) {
+         cursor.bsMonth = 1;
+         ++cursor.bsYear;
+     }
+ }
+ 
+ // Print the calendar of a BS month, or of the whole year when month is 0. One conversion
+ // anchors the first day; everything after it is counted forward.
+ int showCalendar(int year, int month, bool unicode, bool showAd) {
+     if (year <= 0 || month < 0 || month > 12) {
+         std::cerr << "Error: Invalid calendar year or month." << std::endl;
+         return 1;
+     }
+     Bikram bs;
+     CalendarCursor cursor{year, month ? month : 1, 0, 0, 0, 0};
+     bs.toGregorian(cursor.bsYear, cursor.bsMonth, 1, cursor.adYear, cursor.adMonth, cursor.adDay);
+     cursor.weekday = getWeekday(cursor.adYear, cursor.adMonth, cursor.adDay);
+ 
+     std::string out;
+     for (int count = month ? 1 : 12; count > 0; --count) {
+         appendMonthGrid(out, cursor, bs.daysInMonth(cursor.bsYear, cursor.bsMonth), unicode, showAd);
+         if (count > 1) out += '\n';
+     }
+     std::fwrite(out.data(), 1, out.size(), stdout);
+     return 0;
+ }
+ 
+ // Julian Day Number of a date argument such as 2082-05-14, read as AD when isAd is set and
+ // as BS otherwise. Returns false if the text is not a valid date.
+ bool parseDateArgument(std::string_view text, bool isAd, long& jdn) {
+     int y, m, d;
+     if (readDate(text.data(), text.data() + text.size(), isAd, y, m, d) != DATE_INPUT_OK) return false;
+     jdn = isAd ? Bikram::toJulianDay(y, m, d) : Bikram::bsToJulianDay(y, m, d);
+     return true;
+ }
+ 
+ // Call lineFn(p, end) for every line of in, without its newline. The last line need not end
+ // with one, and a line longer than chunkSize grows the buffer.
+ template <typename LineFn>
+ void forEachLine(FILE* in, size_t chunkSize, LineFn lineFn) {
+     std::vector<char> buf(chunkSize);
+     size_t filled = 0;
+     for (;;) {
+         if (filled == buf.size()) buf.resize(buf.size() * 2); // line longer than the buffer
+         size_t n = std::fread(buf.data() + filled, 1, buf.size() - filled, in);
+         if (n == 0) break;
+         filled += n;
+ 
+         const char* start = buf.data();
+         const char* end = buf.data() + filled;
+         for (const char* nl; (nl = static_cast<const char*>(std::memchr(start, '\n', end - start))); start = nl + 1) {
+             lineFn(start, nl);
+         }
+         filled = end - start;
+         std::memmove(buf.data(), start, filled);
+     }
+     if (filled > 0) lineFn(buf.data(), buf.data() + filled);
+ }
+ 
+ // Convert one date per input line (AD to BS, or BS to AD when toAd is set) and write one
+ // formatted result per line. Input is read and output is written in large chunks so a run
+ // over millions of lines is not dominated by per-line flushing.
+ int runBatch(const char* path, std::string_view format, bool unicode, bool toAd, const RecordWriter::Mode* records) {
+     FILE* in = stdin;
+     if (path && std::strcmp(path, "-") != 0) {
+         in = std::fopen(path, "rb");
+         if (!in) {
+             std::cerr << "Error: Cannot open " << path << std::endl;
+             return 1;
+         }
+     }
+ 
+     const size_t chunkSize = 1 << 20;
+     std::string out;
+     if (!records) out.reserve(chunkSize + 4096);
+ 
+     const CompiledFormat compiled(format, CompiledFormat::SIMPLE, unicode, toAd);
+     Bikram bs;
+     long lineNo = 0;
+     long errors = 0;
+ 
+     std::optional<RecordWriter> writer;
+     if (records) writer.emplace(*records);
+ 
+     // Blank input lines are not errors
+     auto reportError = [&](DateInputError error) {
+         if (error == DATE_INPUT_EMPTY) return;
+         ++errors;
+         std::cerr << "Error: line " << lineNo << ": invalid date (" << dateInputMessage(error) << ")" << std::endl;
+     };
+ 
+     // Input is AD, or BS with --ad; a record carries both calendars either way
+     auto writeRecord = [&](const char* p, const char* end) {
+         int y, m, d;
+         DateInputError error = readDate(p, end, !toAd, y, m, d);
+         if (error == DATE_INPUT_OK) {
+             BikramDayIterator day(toAd ? Bikram::bsToJulianDay(y, m, d) : Bikram::toJulianDay(y, m, d));
+             writer->add(*day, day.bsMonthDays());
+             return;
+         }
+         writer->addInvalid();
+         reportError(error);
+     };
+ 
+     auto convertLine = [&](const char* p, const char* end) {
+         ++lineNo;
+         if (writer) return writeRecord(p, end);
+         // Keep output rows aligned with input rows
+         DateInputError error = appendConvertedDate(out, p, end, compiled, toAd, bs);
+         if (error != DATE_INPUT_OK) reportError(error);
+         out += '\n';
+         if (out.size() >= chunkSize) {
+             std::fwrite(out.data(), 1, out.size(), stdout);
+             out.clear();
+         }
+     };
+ 
+     forEachLine(in, chunkSize, convertLine);
+ 
+     std::fwrite(out.data(), 1, out.size(), stdout);
+     std::fflush(stdout);
+     if (writer && !writer->flush()) {
+         std::cerr << "Error: Cannot write output" << std::endl;
+         ++errors;
+     }
+     if (in != stdin) std::fclose(in);
+     return errors ? 1 : 0;
+ }
+ 
+ // Parse an --add offset: a signed count of days (30, -7, 30d), months (3m) or years (2y).
+ // Years are returned as 12 months each.
+ bool parseOffset(std::string_view text, long& count, char& unit) {
+     const char* p = text.data();
+     const char* end = p + text.size();
+     bool negative = p < end && (*p == '-' || *p == '+') && *p++ == '-';
+     if (p == end || end - p > 9) return false;
+     count = 0;
+     const char* digits = p;
+     for (; p < end && *p >= '0' && *p <= '9'; ++p) count = count * 10 + (*p - '0');
+     if (p == digits) return false; // a bare unit such as "d" is not an offset
+     unit = p == end ? 'd' : *p++;
+     if (p != end || (unit != 'd' && unit != 'm' && unit != 'y')) return false;
+     if (unit == 'y') {
+         unit = 'm';
+         count *= 12;
+     }
+     if (negative) count = -count;
+     return true;
+ }
+ 
+ // Print the BS date offset days or months from start
+ int runAdd(std::string_view start, std::string_view offset, std::string_view format, bool unicode) {
+     long jdn, count;
+     char unit;
+     if (!parseDateArgument(start, false, jdn) || !parseOffset(offset, count, unit)) {
+         std::cerr << "Error: Invalid --add arguments: " << start << " " << offset << std::endl;
+         return 1;
+     }
+     Bikram bs;
+     bs.fromJulianDayBs(jdn);
+     if (unit == 'm') {
+         bs.addMonths(bs.getYear(), bs.getMonth(), bs.getDay(), count);
+     } else {
+         bs.fromJulianDayBs(jdn + count);
+     }
+     if (bs.getYear() < 1 || bs.getYear() > 9999) {
+         std::cerr << "Error: Result is outside BS 1-9999." << std::endl;
+         return 1;
+     }
+     displayFormattedDate(bs.getYear(), bs.getMonth(), bs.getDay(), format, unicode, false);
+     return 0;
+ }
+ 
+ // Print the distance from first to last as "D days, M months N days", with months counted in BS
+ void showDiff(long first, long last) {
+     Bikram from, to, moved;
+     from.fromJulianDayBs(first);
+     to.fromJulianDayBs(last);
+     long months = from.monthsBetween(from.getYear(), from.getMonth(), from.getDay(), to.getYear(), to.getMonth(), to.getDay());
+     moved.addMonths(from.getYear(), from.getMonth(), from.getDay(), months);
+     long rest = last - moved.bsToJulianDay(moved.getYear(), moved.getMonth(), moved.getDay());
+     std::cout << last - first << " days, " << months << " months " << rest << " days" << std::endl;
+ }
+ 
+ // Write every step-th day from first to last (inclusive) as a "BS<TAB>AD" row, each side in
+ // the simple format, or as records when records is set. Only the first day is converted; the
+ // iterator carries the rest forward.
+ int runRange(long first, long last, size_t step, std::string_view format, bool unicode, const RecordWriter::Mode* records) {
+     if (records) {
+         RecordWriter writer(*records);
+         for (BikramDayIterator it(first); it->jdn <= last; it.advance(static_cast<long>(step))) {
+             writer.add(*it, it.bsMonthDays());
+             if (static_cast<unsigned long>(last - it->jdn) < step) break;
+         }
+         if (!writer.flush()) {
+             std::cerr << "Error: Cannot write output" << std::endl;
+             return 1;
+         }
+         return 0;
+     }
+ 
+     const CompiledFormat bsFormat(format, CompiledFormat::SIMPLE, unicode, false);
+     const CompiledFormat adFormat(format, CompiledFormat::SIMPLE, unicode, true);
+     const size_t flushSize = 1 << 20;
+     std::string out;
+     out.reserve(flushSize + bsFormat.maxLength() + adFormat.maxLength() + 2);
+ 
+     for (BikramDayIterator it(first); it->jdn <= last; it.advance(static_cast<long>(step))) {
+         bsFormat.appendTo(out, {it->bsYear, it->bsMonth, it->bsDay, it->weekday});
+         out += '\t';
+         adFormat.appendTo(out, {it->adYear, it->adMonth, it->adDay, it->weekday});
+         out += '\n';
+         if (out.size() >= flushSize) {
+             std::fwrite(out.data(), 1, out.size(), stdout);
+             out.clear();
+         }
+         if (static_cast<unsigned long>(last - it->jdn) < step) break;
+     }
+     std::fwrite(out.data(), 1, out.size(), stdout);
+     std::fflush(stdout);
+     return 0;
+ }
+ 
+ // Append the BS date of a day in the simple format, without and with a tab after it
+ void appendBsDay(std::string& out, long jdn, const CompiledFormat& format) {
+     BsDate date = Bikram::bsDate(jdn);
+     format.appendTo(out, {date.year, date.month, date.day, static_cast<int>((jdn + 1) % 7)});
+ }
+
+ void appendEventDay(std::string& out, long jdn, const CompiledFormat& format) {
+     appendBsDay(out, jdn, format);
+     out += '\t';
+ }
+
+ void appendSankrantiName(std::string& out, int bsMonth, bool unicode) {
+     out += unicode ? nepaliRashis[bsMonth - 1] : romanizedRashis[bsMonth - 1];
+     out += unicode ? " संक्रान्ति" : " Sankranti";
+ }
+
+ // --sankranti: the day each month of a BS year begins, the model's time of day and the sign
+ // the sun enters. Where the month table moves the month start off the model's sankranti day,
+ // a fourth column gives the day that time falls on.
+ int showSankrantis(int year, std::string_view format, bool unicode) {
+     const CompiledFormat bsFormat(format, CompiledFormat::SIMPLE, unicode, false);
+     const CompiledFormat timeFormat("%H:%M", CompiledFormat::STRFTIME, unicode, false);
+     std::string out;
+     for (int month = 1; month <= 12; ++month) {
+         SankrantiTime time = Sankranti::of(year, month);
+         appendEventDay(out, time.jdn, bsFormat);
+         timeFormat.appendTo(out, {0, 1, 1, 0, time.minute / 60, time.minute % 60});
+         out += '\t';
+         out += unicode ? nepaliRashis[month - 1] : romanizedRashis[month - 1];
+         if (time.modelDay != 0) {
+             out += '\t';
+             appendBsDay(out, time.jdn + time.modelDay, bsFormat);
+         }
+         out += '\n';
+     }
+     std::fwrite(out.data(), 1, out.size(), stdout);
+     return 0;
+ }
+
+ // --events: every sankranti and loaded holiday from first to last, one "DATE<TAB>NAME" line
+ // each in date order, with the sankranti first on a shared day
+ int runEvents(long first, long last, const HolidayCalendar& holidays, std::string_view format, bool unicode) {
+     const CompiledFormat bsFormat(format, CompiledFormat::SIMPLE, unicode, false);
+     size_t holiday, end;
+     holidays.range(first, last, holiday, end);
+     SankrantiTime sankranti = Sankranti::next(first);
+     std::string out;
+     for (;;) {
+         bool haveSankranti = sankranti.jdn <= last;
+         if (haveSankranti && (holiday == end || sankranti.jdn <= holidays.day(holiday))) {
+             appendEventDay(out, sankranti.jdn, bsFormat);
+             appendSankrantiName(out, sankranti.bsMonth, unicode);
+             sankranti = Sankranti::next(sankranti.jdn + 1);
+         } else if (holiday < end) {
+             appendEventDay(out, holidays.day(holiday), bsFormat);
+             out += holidays.name(holiday++);
+         } else {
+             break;
+         }
+         out += '\n';
+     }
+     std::fwrite(out.data(), 1, out.size(), stdout);
+     std::fflush(stdout);
+     return 0;
+ }
+
+ // --next-event / --prev-event: every event on the nearest day with one, on or after (before) jdn
+ // within BS 1-9999, the range --add keeps to
+ int showNearestEvents(long jdn, bool forward, const HolidayCalendar& holidays, std::string_view format, bool unicode) {
+     const long first = Bikram::bsToJulianDay(1, 1, 1);
+     const long last = Bikram::bsToJulianDay(9999, 12, Bikram::daysInMonth(9999, 12));
+     if (forward && jdn < first) jdn = first;
+     if (!forward && jdn > last) jdn = last;
+     long day = forward ? Sankranti::next(jdn).jdn : Sankranti::previous(jdn).jdn;
+     size_t holiday = forward ? holidays.lowerBound(jdn) : holidays.previous(jdn);
+     if (holiday < holidays.size() && (forward ? holidays.day(holiday) < day : holidays.day(holiday) > day)) {
+         day = holidays.day(holiday);
+     }
+     if (day < first || day > last) {
+         std::cerr << "Error: No " << (forward ? "next" : "previous") << " event within BS 1-9999." << std::endl;
+         return 1;
+     }
+     return runEvents(day, day, holidays, format, unicode);
+ }
+
+ // Load --holidays FILE, if given, reporting any error
+ bool loadHolidays(const char* path, HolidayCalendar& holidays) {
+     if (!path || holidays.load(path)) return true;
+     if (holidays.errorLine() == 0) {
+         std::cerr << "Error: Cannot read holidays file: " << path << std::endl;
+     } else {
+         std::cerr << "Error: " << path << ":" << holidays.errorLine()
+                   << ": expected 'YYYY-MM-DD Name' or 'YYYY-MM-DD..YYYY-MM-DD Name' (BS dates)" << std::endl;
+     }
+     return false;
+ }
+
+ // Largest --threads accepted; more would only add start-up cost and risk running out of threads
+ const size_t MAX_CSV_THREADS = 1024;
+
+ // Options for --csv
+ struct CsvOptions {
+     size_t column = 0;         // 0-based index of the date column
+     char delimiter = ',';
+     bool header = false;       // copy the first line through unchanged
+     unsigned threads = 0;      // 0 = one per hardware thread, at most MAX_CSV_THREADS
+     size_t chunkSize = 8 << 20;
+     std::string_view format = "y-m-d";
+     bool unicode = false;
+     bool toAd = false;
+ };
+ 
+ // Append one CSV line to out with the date in opt.column converted. Quoted fields are
+ // respected when looking for the column; the converted value is quoted when needed.
+ // On failure the line is appended unchanged and the reason is returned; a line without the
+ // column gives DATE_INPUT_EMPTY.
+ DateInputError convertCsvLine(std::string& out, const char* p, const char* end, const CsvOptions& opt,
+                               const CompiledFormat& format, Bikram& bs) {
+     const char* lineEnd = (end > p && end[-1] == '\r') ? end - 1 : end;
+ 
+     const char* field = p;
+     size_t col = 0;
+     bool quoted = false;
+     const char* c = p;
+     for (; c < lineEnd && col < opt.column; ++c) {
+         if (*c == '"') {
+             quoted = !quoted;
+         } else if (*c == opt.delimiter && !quoted) {
+             ++col;
+             field = c + 1;
+         }
+     }
+     if (col < opt.column) {
+         out.append(p, end);
+         return DATE_INPUT_EMPTY;
+     }
+     const char* fieldEnd = field;
+     for (quoted = false; fieldEnd < lineEnd && (quoted || *fieldEnd != opt.delimiter); ++fieldEnd) {
+         if (*fieldEnd == '"') quoted = !quoted;
+     }
+ 
+     const char* value = field;
+     const char* valueEnd = fieldEnd;
+     bool wasQuoted = valueEnd - value >= 2 && *value == '"' && valueEnd[-1] == '"';
+     if (wasQuoted) {
+         ++value;
+         --valueEnd;
+     }
+ 
+     size_t prefix = out.size();
+     out.append(p, field);
+     size_t start = out.size();
+     DateInputError error = appendConvertedDate(out, value, valueEnd, format, opt.toAd, bs);
+     if (error != DATE_INPUT_OK) {
+         out.resize(prefix);
+         out.append(p, end);
+         return error;
+     }
+     bool needsQuotes = wasQuoted || out.find_first_of(std::string(1, opt.delimiter) + "\"\n", start) != std::string::npos;
+     if (needsQuotes) {
+         std::string converted = out.substr(start);
+         out.resize(start);
+         out += '"';
+         for (char ch : converted) {
+             if (ch == '"') out += '"';
+             out += ch;
+         }
+         out += '"';
+     }
+     out.append(fieldEnd, end);
+     return DATE_INPUT_OK;
+ }
+ 
+ // Convert one column of a CSV file using all cores. The file is memory-mapped and split
+ // into line-aligned chunks; worker threads convert chunks into private buffers, and the
+ // main thread writes finished chunks in file order. At most a few chunks per thread are in
+ // flight, so memory use stays bounded for multi-GB inputs.
+ int runCsv(const char* path, const CsvOptions& opt) {
+     int fd = open(path, O_RDONLY);
+     if (fd < 0) {
+         std::cerr << "Error: Cannot open " << path << std::endl;
+         return 1;
+     }
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         std::cerr << "Error: Cannot stat " << path << std::endl;
+         close(fd);
+         return 1;
+     }
+     size_t size = static_cast<size_t>(st.st_size);
+     if (size == 0) {
+         close(fd);
+         return 0;
+     }
+     void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (mapped == MAP_FAILED) {
+         std::cerr << "Error: Cannot map " << path << std::endl;
+         return 1;
+     }
+     madvise(mapped, size, MADV_SEQUENTIAL);
+     const char* data = static_cast<const char*>(mapped);
+     const char* dataEnd = data + size;
+ 
+     // Line-aligned chunk boundaries
+     const char* body = data;
+     if (opt.header) {
+         const char* nl = static_cast<const char*>(std::memchr(data, '\n', size));
+         body = nl ? nl + 1 : dataEnd;
+         std::fwrite(data, 1, body - data, stdout);
+     }
+     std::vector<const char*> bounds{body};
+     while (bounds.back() < dataEnd) {
+         // Compare sizes rather than pointers, so a huge chunk size never points past the mapping
+         const char* next = dataEnd;
+         if (opt.chunkSize < static_cast<size_t>(dataEnd - bounds.back())) {
+             next = bounds.back() + std::max<size_t>(opt.chunkSize, 1);
+             const char* nl = static_cast<const char*>(std::memchr(next, '\n', dataEnd - next));
+             next = nl ? nl + 1 : dataEnd;
+         }
+         bounds.push_back(next);
+     }
+     const size_t chunkCount = bounds.size() - 1;
+ 
+     struct Chunk {
+         std::string out;
+         std::vector<std::pair<long, DateInputError>> errors; // chunk-relative, 1-based lines
+         long lines = 0;
+         bool done = false;
+     };
+     std::vector<Chunk> chunks(chunkCount);
+ 
+     unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+     const size_t window = static_cast<size_t>(threads) * 4;
+     const CompiledFormat format(opt.format, CompiledFormat::SIMPLE, opt.unicode, opt.toAd);
+     std::mutex mutex;
+     std::condition_variable chunkDone, chunkWritten;
+     size_t nextChunk = 0;
+     size_t written = 0;
+ 
+     auto worker = [&]() {
+         Bikram bs;
+         for (;;) {
+             size_t index;
+             {
+                 std::unique_lock<std::mutex> lock(mutex);
+                 chunkWritten.wait(lock, [&] { return nextChunk >= chunkCount || nextChunk < written + window; });
+                 if (nextChunk >= chunkCount) return;
+                 index = nextChunk++;
+             }
+             Chunk& chunk = chunks[index];
+             chunk.out.reserve(static_cast<size_t>(bounds[index + 1] - bounds[index]) + 4096);
+             const char* start = bounds[index];
+             const char* end = bounds[index + 1];
+             while (start < end) {
+                 const char* nl = static_cast<const char*>(std::memchr(start, '\n', end - start));
+                 const char* lineEnd = nl ? nl : end;
+                 ++chunk.lines;
+                 DateInputError error = convertCsvLine(chunk.out, start, lineEnd, opt, format, bs);
+                 if (error != DATE_INPUT_OK) chunk.errors.emplace_back(chunk.lines, error);
+                 if (nl) chunk.out += '\n';
+                 start = lineEnd + 1;
+             }
+             {
+                 std::lock_guard<std::mutex> lock(mutex);
+                 chunk.done = true;
+             }
+             chunkDone.notify_one();
+         }
+     };
+ 
+     std::vector<std::thread> pool;
+     try {
+         for (unsigned t = 0; t < threads; ++t) {
+             pool.emplace_back(worker);
+         }
+     } catch (const std::system_error& e) {
+         // Out of threads: the ones already running can do all the chunks
+         if (pool.empty()) {
+             std::cerr << "Error: Cannot start a worker thread: " << e.what() << std::endl;
+             munmap(mapped, size);
+             return 1;
+         }
+     }
+ 
+     long lineBase = opt.header ? 1 : 0;
+     long errors = 0;
+     for (size_t index = 0; index < chunkCount; ++index) {
+         Chunk& chunk = chunks[index];
+         {
+             std::unique_lock<std::mutex> lock(mutex);
+             chunkDone.wait(lock, [&] { return chunk.done; });
+         }
+         std::fwrite(chunk.out.data(), 1, chunk.out.size(), stdout);
+         for (const auto& [line, error] : chunk.errors) {
+             std::cerr << "Error: line " << lineBase + line << ": invalid date in column " << opt.column + 1
+                       << " (" << dateInputMessage(error) << ")" << std::endl;
+         }
+         errors += static_cast<long>(chunk.errors.size());
+         lineBase += chunk.lines;
+         std::string().swap(chunk.out);
+         {
+             std::lock_guard<std::mutex> lock(mutex);
+             written = index + 1;
+         }
+         chunkWritten.notify_all();
+     }
+ 
+     for (auto& t : pool) {
+         t.join();
+     }
+     std::fflush(stdout);
+     munmap(mapped, size);
+     return errors ? 1 : 0;
+ }
+ 
+ // Parse a byte count such as 4194304, 512k or 8M. Only digits and one suffix are accepted,
+ // so a sign, leading space or a value that does not fit size_t is rejected.
+ bool parseSize(const char* text, size_t& size) {
+     if (*text < '0' || *text > '9') return false;
+     errno = 0;
+     char* end = nullptr;
+     unsigned long long value = std::strtoull(text, &end, 10);
+     if (errno == ERANGE) return false;
+     int shift = 0;
+     switch (*end) {
+         case 'k': case 'K': shift = 10; ++end; break;
+         case 'm': case 'M': shift = 20; ++end; break;
+         case 'g': case 'G': shift = 30; ++end; break;
+         default: break;
+     }
+     if (*end != '\0' || value == 0 || value > (SIZE_MAX >> shift)) return false;
+     size = static_cast<size_t>(value << shift);
+     return true;
+ }
+ 
+ // --stats: engine counters and latency histograms as one JSON object on stderr at exit
+ void printStats() {
+     std::string out = "{\"enabled\": ";
+     if (!BIKRAM_STATS_ENABLED) {
+         std::cerr << out << "false}" << std::endl;
+         return;
+     }
+     bikram_stats::Snapshot snap;
+     bikram_stats::snapshot(snap);
+     out += "true";
+     for (int c = 0; c < bikram_stats::COUNTER_COUNT; ++c) {
+         out += ", \"";
+         out += bikram_stats::COUNTER_NAMES[c];
+         out += "\": " + std::to_string(snap.counters[c]);
+     }
+     out += ", \"solver_max_steps\": " + std::to_string(snap.maxSolverSteps);
+     // Only the nonempty buckets, keyed by their lower bound in nanoseconds
+     for (int p = 0; p < bikram_stats::PHASE_COUNT; ++p) {
+         out += ", \"";
+         out += bikram_stats::PHASE_NAMES[p];
+         out += "_ns\": {";
+         bool first = true;
+         for (int b = 0; b < bikram_stats::HISTOGRAM_BUCKETS; ++b) {
+             if (snap.histograms[p][b] == 0) continue;
+             out += first ? "\"" : ", \"";
+             out += std::to_string(1ULL << b) + "\": " + std::to_string(snap.histograms[p][b]);
+             first = false;
+         }
+         out += "}";
+     }
+     std::cerr << out << "}" << std::endl;
+ }
+
  // Help message
  void showHelp() {
      std::cerr << "Usage: \n"
                << "  \e[31mShow today's date summary:\e[0m ./nepdate-cli\n"
                << "  \e[31mShow today's date (simple format):\e[0m ./nepdate-cli --today [--ad] [--unicode] [--format y-m-d]\n"
-               << "  \e[31mShow current date & time (strftime):\e[0m ./nepdate-cli --now [--ad] [--unicode] [--format '%Y-%m-%d']\n"
-               << "  \e[31mConvert to Bikram Sambat:\e[0m ./nepdate-cli --tobs yyyy mm dd [--unicode] [--format y-m-d]\n"
-               << "  \e[31mConvert to Gregorian:\e[0m ./nepdate-cli --toad yyyy mm dd [--unicode] [--format y-m-d]\n\n"
+               << "  \e[31mShow current date & time (strftime):\e[0m ./nepdate-cli --now [--ad] [--unicode] [--format '%Y-%m-%d'] [--watch [seconds]]\n"
+               << "  \e[31mConvert to Bikram Sambat:\e[0m ./nepdate-cli --tobs yyyy-mm-dd|yyyy mm dd [--unicode] [--format y-m-d] [--output jsonl]\n"
+               << "  \e[31mConvert to Gregorian:\e[0m ./nepdate-cli --toad yyyy-mm-dd|yyyy mm dd [--unicode] [--format y-m-d] [--output jsonl]\n"
+               << "  \e[31mShow a BS calendar:\e[0m ./nepdate-cli --cal [year [month]] [--ad] [--unicode]\n"
+               << "  \e[31mList the days between two dates:\e[0m ./nepdate-cli --range START END [--step N] [--ad] [--unicode] [--format y-m-d] [--output jsonl]\n"
+               << "  \e[31mRun a conversion daemon:\e[0m ./nepdate-cli --serve [--socket path]\n"
+               << "  \e[31mAdd days, months or years to a BS date:\e[0m ./nepdate-cli --add DATE N[d|m|y] [--unicode] [--format y-m-d]\n"
+               << "  \e[31mCount days and BS months between two dates:\e[0m ./nepdate-cli --diff START END [--ad]\n"
+               << "  \e[31mList the sankrantis of a BS year:\e[0m ./nepdate-cli --sankranti [year] [--unicode] [--format y-m-d]\n"
+               << "  \e[31mList sankrantis and holidays:\e[0m ./nepdate-cli --events START END [--holidays file] [--ad] [--unicode] [--format y-m-d]\n"
+               << "  \e[31mShow the next or previous event:\e[0m ./nepdate-cli --next-event|--prev-event [DATE] [--holidays file] [--ad]\n"
+               << "  \e[31mConvert one date per line:\e[0m ./nepdate-cli --batch [file] [--ad] [--unicode] [--format y-m-d] [--output jsonl]\n"
+               << "  \e[31mConvert a CSV date column:\e[0m ./nepdate-cli --csv file --column N [--ad] [--header] [--delimiter ,]\n"
+               << "                             [--threads N] [--chunk-size 8M] [--unicode] [--format y-m-d]\n\n"
                << "Options:\n"
-               << "  \e[31m--ad:\e[0m      Show date in AD when used with --today or --now\n"
+               << "  \e[31m--ad:\e[0m      Show date in AD when used with --today or --now; with --batch or --csv, read BS and write AD;\n"
+               << "            with --cal, show the AD day next to each BS day; with --range, --diff or --events, read START and END as AD\n"
+               << "  \e[31m--watch:\e[0m   With --now, keep printing every N seconds (default 1) until interrupted\n"
+               << "  \e[31m--socket:\e[0m  With --tobs or --toad, ask the --serve daemon (falls back to converting in-process);\n"
+               << "            the default socket is $XDG_RUNTIME_DIR/nepdate-cli.sock\n"
+               << "  \e[31m--holidays:\e[0m With the event commands, also list holidays from a file of 'YYYY-MM-DD Name'\n"
+               << "            or 'YYYY-MM-DD..YYYY-MM-DD Name' lines (BS dates; '#' starts a comment)\n"
+               << "  \e[31m--output:\e[0m With --tobs, --toad, --range or --batch, write text (default), jsonl, csv or binary\n"
+               << "            records carrying the BS and AD dates, weekday and BS month length; see README\n"
+               << "  \e[31m--stats:\e[0m   Print engine counters (table hits, fallbacks, solver work) as JSON on stderr at exit;\n"
+               << "            counting needs a build with -DBIKRAM_STATS=ON\n"
                << "  \e[31m--unicode:\e[0m Display Unicode (Devanagari) output\n"
                << "  \e[31m--format:\e[0m  Format string (see specifiers for each command).\n\n"
-               << "Simple Format Specifiers (\e[33mfor --today, --tobs, --toad\e[0m):\n"
+               << "Simple Format Specifiers (\e[33mfor --today, --tobs, --toad, --range, --add, --sankranti, --events, --batch, --csv\e[0m):\n"
                << "  \e[31my:\e[0m Year \e[31mm:\e[0m Month \e[31md:\e[0m Day \e[31mM:\e[0m Month name \e[31mw:\e[0m Weekday(NP) \e[31mW:\e[0m Weekday(EN)\n\n"
                << "strftime Format Specifiers (\e[33mfor --now\e[0m):\n"
                << "  \e[31m%Y\e[0m: Year \e[31m%y\e[0m: Year(2-digit) \e[31m%m\e[0m: Month(01-12) \e[31m%d\e[0m: Day(01-31)\n"
@@ -339,6 +908,22 @@
                << "  \e[32m# Convert a specific AD date to BS (simple format)\e[0m\n"
                << "  $ \e[31m./nepdate-cli --tobs 2025 8 30 --format 'y-M-d, W'\e[0m\n"
                << "  \e[35m> 2082-Bhadra-14, Saturday\e[0m\n\n"
+               << "  \e[32m# Show the BS calendar for Bhadra 2082 with AD days\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --cal 2082 5 --ad\e[0m\n\n"
+               << "  \e[32m# List every 7th day of Baisakh 2082 as BS and AD columns\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --range 2082-01-01 2082-01-31 --step 7\e[0m\n\n"
+               << "  \e[32m# Keep a daemon running and convert through it from scripts\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --serve &\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --tobs 2025 8 30 --socket\e[0m\n\n"
+               << "  \e[32m# Due date 30 days after 15 Poush 2082, and the distance back to 1 Baisakh\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --add 2082-09-15 30\e[0m\n"
+               << "  \e[35m> 2082-10-15\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --diff 2082-01-01 2082-09-15\e[0m\n"
+               << "  \e[35m> 260 days, 8 months 14 days\e[0m\n\n"
+               << "  \e[32m# Convert a file of AD dates (yyyy-mm-dd, yyyy/mm/dd or yyyy mm dd) to BS\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --batch dates.txt > bs-dates.txt\e[0m\n\n"
+               << "  \e[32m# Convert the 3rd column of a CSV export from AD to BS on all cores\e[0m\n"
+               << "  $ \e[31m./nepdate-cli --csv ledger.csv --column 3 --header > ledger-bs.csv\e[0m\n\n"
                << "\e[35mFor more info: https://github.com/opensource-nepal/nepdate-cli\e[0m\n";
  }
  
@@ -349,16 +934,34 @@
          return 0;
      }
  
-     std::vector<std::string> args(argv + 1, argv + argc);
-     std::string command;
+     // Arguments are read in place from argv, so parsing them allocates nothing
+     std::string_view command;
      bool unicode = false;
-     std::string format;
+     std::string_view format;
      int y = 0, m = 0, d = 0;
      bool showAdDate = false;
+     const char* batchPath = nullptr;
+     const char* csvPath = nullptr;
+     CsvOptions csv;
+     int calYear = 0, calMonth = 0;
+     std::string_view rangeStart, rangeEnd;
+     std::string_view addDate, addOffset;
+     size_t rangeStep = 1;
+     bool useSocket = false;
+     long watchInterval = 0;
+     const char* socketArg = nullptr;
+     const char* holidaysPath = nullptr;
+     std::string_view eventDate;
+     int sankrantiYear = 0;
+     RecordWriter::Mode recordMode;
+     const RecordWriter::Mode* records = nullptr; // set by --output jsonl|csv|binary
  
      // Find command first to set default format
-     for(const auto& arg : args) {
-         if(arg == "--today" || arg == "--now" || arg == "--tobs" || arg == "--toad") {
+     for (int i = 1; i < argc; ++i) {
+         std::string_view arg = argv[i];
+         if (arg == "--today" || arg == "--now" || arg == "--tobs" || arg == "--toad" || arg == "--batch" || arg == "--csv" ||
+             arg == "--cal" || arg == "--range" || arg == "--add" || arg == "--diff" || arg == "--serve" ||
+             arg == "--sankranti" || arg == "--events" || arg == "--next-event" || arg == "--prev-event") {
              command = arg;
              break;
          }
@@ -370,33 +973,181 @@
          format = "y-m-d";
      }
  
-     for (size_t i = 0; i < args.size(); ++i) {
-         if (args[i] == "--today" || args[i] == "--now") {
+     // True when argv[i + 1] exists and is a value rather than the next option
+     auto hasValue = [&](int i) { return i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0; };
+ 
+     for (int i = 1; i < argc; ++i) {
+         std::string_view arg = argv[i];
+         if (arg == "--today" || arg == "--now") {
              // Already handled
-         } else if ((args[i] == "--tobs" || args[i] == "--toad") && i + 3 < args.size()) {
-             try {
-                 y = std::stoi(args[i + 1]);
-                 m = std::stoi(args[i + 2]);
-                 d = std::stoi(args[i + 3]);
-                 i += 3; // Skip date parts
-             } catch (const std::invalid_argument& ia) {
-                 std::cerr << "Error: Invalid date arguments." << std::endl;
+         } else if ((arg == "--tobs" || arg == "--toad") && i + 1 < argc) {
+             // One argument such as 2025-08-30 or २०८२-०५-१४, or year, month and day as three,
+             // each parsed where it lies in argv
+             bool isAd = arg == "--tobs";
+             const char* date = argv[++i];
+             const char* dateEnd = date + std::strlen(date);
+             DateInputError error;
+             if (parseDateFields(date, dateEnd, y, m, d)) {
+                 error = checkDate(isAd, y, m, d);
+             } else if (i + 2 < argc) {
+                 int* fields[] = {&y, &m, &d};
+                 bool parsed = true;
+                 for (int f = 0; f < 3 && parsed; ++f) {
+                     const char* p = argv[i + f];
+                     const char* fieldEnd = p + std::strlen(p);
+                     parsed = readDateField(p, fieldEnd, *fields[f]) && p == fieldEnd;
+                 }
+                 error = parsed ? checkDate(isAd, y, m, d) : DATE_INPUT_SYNTAX;
+                 i += 2;
+             } else {
+                 error = readDate(date, dateEnd, isAd, y, m, d); // for the reason it fails
+             }
+             if (error != DATE_INPUT_OK) {
+                 std::cerr << "Error: Invalid date arguments (" << dateInputMessage(error) << ")." << std::endl;
                  showHelp();
                  return 1;
              }
-         } else if (args[i] == "--unicode") {
+         } else if (arg == "--unicode") {
              unicode = true;
-         } else if (args[i] == "--format" && i + 1 < args.size()) {
-             format = args[++i];
-         } else if (args[i] == "--ad") {
+         } else if (arg == "--stats") {
+             std::atexit(printStats);
+         } else if (arg == "--output" && i + 1 < argc) {
+             std::string_view value = argv[++i];
+             if (RecordWriter::parseMode(value, recordMode)) {
+                 records = &recordMode;
+             } else if (value == "text") {
+                 records = nullptr;
+             } else {
+                 std::cerr << "Error: Invalid value for --output: " << value << std::endl;
+                 return 1;
+             }
+         } else if (arg == "--format" && i + 1 < argc) {
+             format = argv[++i];
+         } else if (arg == "--ad") {
              showAdDate = true;
+         } else if (arg == "--batch") {
+             if (hasValue(i)) {
+                 batchPath = argv[++i];
+             }
+         } else if (arg == "--cal") {
+             // Optional year and month
+             for (int* field : {&calYear, &calMonth}) {
+                 if (!hasValue(i)) break;
+                 char* end = nullptr;
+                 long value = std::strtol(argv[i + 1], &end, 10);
+                 if (*end != '\0' || value <= 0 || value > 9999) {
+                     std::cerr << "Error: Invalid calendar argument: " << argv[i + 1] << std::endl;
+                     return 1;
+                 }
+                 *field = static_cast<int>(value);
+                 ++i;
+             }
+         } else if (arg == "--add" && i + 2 < argc) {
+             addDate = argv[++i];
+             addOffset = argv[++i];
+         } else if ((arg == "--range" || arg == "--diff" || arg == "--events") && i + 2 < argc) {
+             rangeStart = argv[++i];
+             rangeEnd = argv[++i];
+         } else if (arg == "--step" && i + 1 < argc) {
+             // A plain day count: digits only, no sign or size suffix
+             const char* text = argv[++i];
+             char* end = nullptr;
+             errno = 0;
+             long value = std::strtol(text, &end, 10);
+             if (*text < '0' || *text > '9' || *end != '\0' || errno == ERANGE || value < 1) {
+                 std::cerr << "Error: Invalid value for --step: " << text << std::endl;
+                 return 1;
+             }
+             rangeStep = static_cast<size_t>(value);
+         } else if (arg == "--watch") {
+             watchInterval = 1;
+             if (hasValue(i)) {
+                 char* end = nullptr;
+                 watchInterval = std::strtol(argv[++i], &end, 10);
+                 if (*end != '\0' || watchInterval < 1 || watchInterval > 86400) {
+                     std::cerr << "Error: Invalid --watch interval: " << argv[i] << std::endl;
+                     return 1;
+                 }
+             }
+         } else if (arg == "--socket") {
+             useSocket = true;
+             if (hasValue(i)) {
+                 socketArg = argv[++i];
+             }
+         } else if (arg == "--sankranti") {
+             if (hasValue(i)) {
+                 char* end = nullptr;
+                 long value = std::strtol(argv[++i], &end, 10);
+                 if (*end != '\0' || value <= 0 || value > 9999) {
+                     std::cerr << "Error: Invalid --sankranti year: " << argv[i] << std::endl;
+                     return 1;
+                 }
+                 sankrantiYear = static_cast<int>(value);
+             }
+         } else if (arg == "--next-event" || arg == "--prev-event") {
+             if (hasValue(i)) {
+                 eventDate = argv[++i];
+             }
+         } else if (arg == "--holidays" && i + 1 < argc) {
+             holidaysPath = argv[++i];
+         } else if (arg == "--csv" && i + 1 < argc) {
+             csvPath = argv[++i];
+         } else if (arg == "--header") {
+             csv.header = true;
+         } else if ((arg == "--column" || arg == "--threads" || arg == "--chunk-size" || arg == "--delimiter")
+                    && i + 1 < argc) {
+             std::string_view value = argv[++i];
+             size_t number = 0;
+             bool ok = true;
+             if (arg == "--delimiter") {
+                 ok = value.size() == 1 || value == "\\t";
+                 if (ok) csv.delimiter = value == "\\t" ? '\t' : value[0];
+             } else {
+                 ok = parseSize(argv[i], number);
+             }
+             if (!ok || (arg == "--column" && number == 0) || (arg == "--threads" && number > MAX_CSV_THREADS)) {
+                 std::cerr << "Error: Invalid value for " << arg << ": " << value << std::endl;
+                 return 1;
+             }
+             if (arg == "--column") csv.column = number - 1;
+             if (arg == "--threads") csv.threads = static_cast<unsigned>(number);
+             if (arg == "--chunk-size") csv.chunkSize = number;
          }
      }
  
      if (command == "--today") {
          showFormattedToday(format, unicode, showAdDate);
+     } else if (command == "--now" && watchInterval > 0) {
+         return watchNow(format, unicode, showAdDate, watchInterval);
      } else if (command == "--now") {
          showFormattedNow(format, unicode, showAdDate);
+     } else if (command == "--serve") {
+         return runServer(socketArg ? socketArg : defaultSocketPath());
+     } else if ((command == "--tobs" || command == "--toad") && y != 0 && records) {
+         RecordWriter writer(*records);
+         BikramDayIterator day(command == "--tobs" ? Bikram::toJulianDay(y, m, d) : Bikram::bsToJulianDay(y, m, d));
+         writer.add(*day, day.bsMonthDays());
+         if (!writer.flush()) {
+             std::cerr << "Error: Cannot write output" << std::endl;
+             return 1;
+         }
+     } else if ((command == "--tobs" || command == "--toad") && y != 0 && useSocket) {
+         // Ask the daemon, answering in-process when none is running so the output is the same either way
+         std::string request(command.substr(2));
+         request += unicode ? " --unicode " : " ";
+         request += std::to_string(y) + "-" + std::to_string(m) + "-" + std::to_string(d) + " ";
+         request += format;
+         std::string answer;
+         if (!queryDaemon(socketArg ? socketArg : defaultSocketPath(), request, answer)) {
+             DaemonState state;
+             answer.clear();
+             state.handle(request.data(), request.data() + request.size(), answer);
+         }
+         if (answer.compare(0, 3, "ok ") != 0) {
+             std::cerr << "Error: " << (answer.size() > 6 ? answer.substr(6, answer.size() - 7) : "no answer from daemon") << std::endl;
+             return 1;
+         }
+         std::cout << answer.substr(3) << std::flush;
      } else if (command == "--tobs" && y != 0) {
          Bikram bs;
          bs.fromGregorian(y, m, d);
@@ -406,6 +1157,74 @@
          int gy, gm, gd;
          bs.toGregorian(y, m, d, gy, gm, gd);
          displayFormattedDate(gy, gm, gd, format, unicode, true);
+     } else if (command == "--cal") {
+         if (calYear == 0) {
+             // Current BS month
+             int gy, gm, gd;
+             getCurrentDate(gy, gm, gd);
+             Bikram bs;
+             bs.fromGregorian(gy, gm, gd);
+             calYear = bs.getYear();
+             calMonth = bs.getMonth();
+         }
+         return showCalendar(calYear, calMonth, unicode, showAdDate);
+     } else if (command == "--range" && !rangeStart.empty()) {
+         long first = 0, last = 0;
+         if (!parseDateArgument(rangeStart, showAdDate, first) || !parseDateArgument(rangeEnd, showAdDate, last)) {
+             std::cerr << "Error: Invalid " << (showAdDate ? "AD" : "BS") << " date range: " << rangeStart << " " << rangeEnd << std::endl;
+             return 1;
+         }
+         if (last < first) {
+             std::cerr << "Error: END is before START." << std::endl;
+             return 1;
+         }
+         return runRange(first, last, rangeStep, format, unicode, records);
+     } else if (command == "--add" && !addDate.empty()) {
+         return runAdd(addDate, addOffset, format, unicode);
+     } else if (command == "--diff" && !rangeStart.empty()) {
+         long first = 0, last = 0;
+         if (!parseDateArgument(rangeStart, showAdDate, first) || !parseDateArgument(rangeEnd, showAdDate, last)) {
+             std::cerr << "Error: Invalid " << (showAdDate ? "AD" : "BS") << " dates: " << rangeStart << " " << rangeEnd << std::endl;
+             return 1;
+         }
+         showDiff(first, last);
+     } else if (command == "--sankranti") {
+         if (sankrantiYear == 0) {
+             int gy, gm, gd;
+             getCurrentDate(gy, gm, gd);
+             sankrantiYear = Bikram::toBs({gy, gm, gd}).year;
+         }
+         return showSankrantis(sankrantiYear, format, unicode);
+     } else if (command == "--events" && !rangeStart.empty()) {
+         long first = 0, last = 0;
+         if (!parseDateArgument(rangeStart, showAdDate, first) || !parseDateArgument(rangeEnd, showAdDate, last)) {
+             std::cerr << "Error: Invalid " << (showAdDate ? "AD" : "BS") << " date range: " << rangeStart << " " << rangeEnd << std::endl;
+             return 1;
+         }
+         HolidayCalendar holidays;
+         if (!loadHolidays(holidaysPath, holidays)) return 1;
+         return runEvents(first, last, holidays, format, unicode);
+     } else if (command == "--next-event" || command == "--prev-event") {
+         long jdn = 0;
+         if (eventDate.empty()) {
+             int gy, gm, gd;
+             getCurrentDate(gy, gm, gd);
+             jdn = Bikram::toJulianDay(gy, gm, gd);
+         } else if (!parseDateArgument(eventDate, showAdDate, jdn)) {
+             std::cerr << "Error: Invalid " << (showAdDate ? "AD" : "BS") << " date: " << eventDate << std::endl;
+             return 1;
+         }
+         HolidayCalendar holidays;
+         if (!loadHolidays(holidaysPath, holidays)) return 1;
+         return showNearestEvents(jdn, command == "--next-event", holidays, format, unicode);
+     } else if (command == "--batch") {
+         std::ios::sync_with_stdio(false);
+         return runBatch(batchPath, format, unicode, showAdDate, records);
+     } else if (command == "--csv" && csvPath) {
+         csv.format = format;
+         csv.unicode = unicode;
+         csv.toAd = showAdDate;
+         return runCsv(csvPath, csv);
      } else {
          showHelp();
          return 1;
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Machine-readable date records for --output jsonl|csv|binary.
+ //
+ // Every record carries both calendars, the weekday and the length of the BS month:
+ //   jsonl   {"bs":"2082-05-14","ad":"2025-08-30","weekday":6,"bs_days_in_month":31}
+ //   csv     bs,ad,weekday,bs_days_in_month header, then 2082-05-14,2025-08-30,6,31
+ //   binary  12-byte little-endian records:
+ //             0  uint16 BS year      4  uint16 AD year      8  uint8 weekday (0 = Sunday)
+ //             2  uint8  BS month     6  uint8  AD month     9  uint8 days in the BS month
+ //             3  uint8  BS day       7  uint8  AD day      10  2 zero bytes
+ // An input that is not a date gives a null JSON line, an empty CSV row or an all-zero record,
+ // so output rows stay aligned with input rows. Text years before AD 1 are written with a sign
+ // (year 0 is 1 BC, as in ISO 8601: -0047-03-12); a binary year below 0 or past 65535 has no
+ // uint16 encoding and gives an all-zero record.
+ //
+ // Records are encoded straight into one fixed buffer that is handed to write(2) whole when it
+ // fills, so the cost per record is a few dozen byte stores and no stdio or iostream calls.
+
+ #ifndef RECORDWRITER_H
+ #define RECORDWRITER_H
+
+ #include "bikram.h"
+ #include <cerrno>
+ #include <cstdlib>
+ #include <string_view>
+ #include <unistd.h>
+
+ class RecordWriter {
+ public:
+     enum Mode { JSONL, CSV, BINARY };
+
+     static constexpr std::size_t BINARY_RECORD_SIZE = 12;
+
+     // Mode for an --output name; false for "text" or anything unknown
+     static bool parseMode(std::string_view name, Mode& mode) {
+         if (name == "jsonl") mode = JSONL;
+         else if (name == "csv") mode = CSV;
+         else if (name == "binary") mode = BINARY;
+         else return false;
+         return true;
+     }
+
+     explicit RecordWriter(Mode mode, int fd = STDOUT_FILENO)
+         : mode(mode), fd(fd), buffer(static_cast<char*>(std::malloc(BUFFER_SIZE))), used(0), failed(!buffer) {
+         if (mode == CSV && buffer) append("bs,ad,weekday,bs_days_in_month\n");
+     }
+     ~RecordWriter() {
+         flush();
+         std::free(buffer);
+     }
+     RecordWriter(const RecordWriter&) = delete;
+     RecordWriter& operator=(const RecordWriter&) = delete;
+
+     void add(const BikramDatePair& date, int bsMonthDays) {
+         if (mode == BINARY && (date.bsYear < 0 || date.bsYear > 0xffff || date.adYear < 0 || date.adYear > 0xffff)) {
+             return addInvalid();
+         }
+         if (used > BUFFER_SIZE - MAX_RECORD_SIZE) flush();
+         if (failed) return;
+         char* p = buffer + used;
+         switch (mode) {
+             case JSONL:
+                 p = copy(p, "{\"bs\":\"");
+                 p = putDate(p, date.bsYear, date.bsMonth, date.bsDay);
+                 p = copy(p, "\",\"ad\":\"");
+                 p = putDate(p, date.adYear, date.adMonth, date.adDay);
+                 p = copy(p, "\",\"weekday\":");
+                 *p++ = static_cast<char>('0' + date.weekday);
+                 p = copy(p, ",\"bs_days_in_month\":");
+                 p = putDigits(p, bsMonthDays, 2);
+                 p = copy(p, "}\n");
+                 break;
+             case CSV:
+                 p = putDate(p, date.bsYear, date.bsMonth, date.bsDay);
+                 *p++ = ',';
+                 p = putDate(p, date.adYear, date.adMonth, date.adDay);
+                 *p++ = ',';
+                 *p++ = static_cast<char>('0' + date.weekday);
+                 *p++ = ',';
+                 p = putDigits(p, bsMonthDays, 2);
+                 *p++ = '\n';
+                 break;
+             case BINARY:
+                 p = putUint16(p, date.bsYear);
+                 *p++ = static_cast<char>(date.bsMonth);
+                 *p++ = static_cast<char>(date.bsDay);
+                 p = putUint16(p, date.adYear);
+                 *p++ = static_cast<char>(date.adMonth);
+                 *p++ = static_cast<char>(date.adDay);
+                 *p++ = static_cast<char>(date.weekday);
+                 *p++ = static_cast<char>(bsMonthDays);
+                 *p++ = 0;
+                 *p++ = 0;
+                 break;
+         }
+         used = static_cast<std::size_t>(p - buffer);
+     }
+
+     // Placeholder for an input that is not a date
+     void addInvalid() {
+         if (used > BUFFER_SIZE - MAX_RECORD_SIZE) flush();
+         if (failed) return;
+         switch (mode) {
+             case JSONL: append("null\n"); break;
+             case CSV: append(",,,\n"); break;
+             case BINARY:
+                 for (std::size_t i = 0; i < BINARY_RECORD_SIZE; ++i) buffer[used++] = 0;
+                 break;
+         }
+     }
+
+     // Write out everything buffered. False once any write has failed.
+     bool flush() {
+         for (std::size_t done = 0; !failed && done < used; ) {
+             ssize_t n = ::write(fd, buffer + done, used - done);
+             if (n > 0) {
+                 done += static_cast<std::size_t>(n);
+             } else if (n < 0 && errno != EINTR) {
+                 failed = true;
+             }
+         }
+         used = 0;
+         return !failed;
+     }
+
+ private:
+     static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+     static constexpr std::size_t MAX_RECORD_SIZE = 96;
+
+     template <std::size_t N>
+     static char* copy(char* p, const char (&text)[N]) {
+         for (std::size_t i = 0; i + 1 < N; ++i) *p++ = text[i];
+         return p;
+     }
+
+     void append(std::string_view text) {
+         for (char c : text) buffer[used++] = c;
+     }
+
+     // value in at least width digits, zero-padded, after a '-' if it is negative
+     static char* putDigits(char* p, int value, int width) {
+         if (value < 0) {
+             *p++ = '-';
+             value = -value;
+         }
+         char digits[12];
+         int count = 0;
+         do {
+             digits[count++] = static_cast<char>('0' + value % 10);
+             value /= 10;
+         } while (value > 0);
+         for (; count < width; --width) *p++ = '0';
+         while (count > 0) *p++ = digits[--count];
+         return p;
+     }
+
+     static char* putDate(char* p, int year, int month, int day) {
+         p = putDigits(p, year, 4);
+         *p++ = '-';
+         p = putDigits(p, month, 2);
+         *p++ = '-';
+         return putDigits(p, day, 2);
+     }
+
+     static char* putUint16(char* p, int value) {
+         *p++ = static_cast<char>(value & 0xff);
+         *p++ = static_cast<char>((value >> 8) & 0xff);
+         return p;
+     }
+
+     Mode mode;
+     int fd;
+     char* buffer;
+     std::size_t used;
+     bool failed;
+ };
+
+ #endif // RECORDWRITER_H
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // nepdate-bench: microbenchmarks for the conversion and formatting paths.
+ //
+ // Each benchmark runs for at least --min-time seconds and reports ns/op and heap
+ // allocations/op as JSON on stdout, e.g.
+ //   {"benchmarks": [{"name": "fromGregorian/table_start", "iterations": 12345678,
+ //                    "ns_per_op": 3.21, "allocs_per_op": 0}, ...]}
+ //
+ // --startup BINARY [--runs N] instead measures process start-up: it runs BINARY N times in
+ // sequence (default 10000) with the remaining arguments and reports the mean wall time per run.
+ #include "bikram.h"
+ #include "bikram_events.h"
+ #include "dateformat.h"
+ #include <atomic>
+ #include <chrono>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <functional>
+ #include <iostream>
+ #include <new>
+ #include <spawn.h>
+ #include <streambuf>
+ #include <string>
+ #include <vector>
+ #include <fcntl.h>
+ #include <sys/wait.h>
+ #include <unistd.h>
+
+ extern char** environ;
+
+ // Count every heap allocation made by the process
+ static std::atomic<unsigned long> allocationCount{0};
+
+ void* operator new(std::size_t size) {
+     allocationCount.fetch_add(1, std::memory_order_relaxed);
+     if (void* p = std::malloc(size ? size : 1)) return p;
+     throw std::bad_alloc();
+ }
+ void* operator new[](std::size_t size) {
+     return operator new(size);
+ }
+ void operator delete(void* p) noexcept {
+     std::free(p);
+ }
+ void operator delete[](void* p) noexcept {
+     std::free(p);
+ }
+ void operator delete(void* p, std::size_t) noexcept {
+     std::free(p);
+ }
+ void operator delete[](void* p, std::size_t) noexcept {
+     std::free(p);
+ }
+
+ // Discards everything written to it, so display* benchmarks measure formatting, not the terminal
+ class NullBuffer : public std::streambuf {
+ protected:
+     int overflow(int c) override { return c; }
+     std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+ };
+
+ // Keep the compiler from optimising a result away
+ template <typename T>
+ inline void keep(const T& value) {
+     asm volatile("" : : "g"(&value) : "memory");
+ }
+
+ struct Benchmark {
+     std::string name;
+     std::function<void()> body;
+ };
+
+ struct Result {
+     std::string name;
+     unsigned long iterations;
+     double nsPerOp;
+     double allocsPerOp;
+ };
+
+ Result run(const Benchmark& bench, double minTime) {
+     using clock = std::chrono::steady_clock;
+     bench.body(); // warm up caches and lazily built state
+     unsigned long iterations = 1;
+     for (;;) {
+         unsigned long allocsBefore = allocationCount.load(std::memory_order_relaxed);
+         auto start = clock::now();
+         for (unsigned long i = 0; i < iterations; ++i) {
+             bench.body();
+         }
+         double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+         unsigned long allocs = allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+         if (elapsed >= minTime || iterations >= (1UL << 40)) {
+             return {bench.name, iterations, elapsed * 1e9 / iterations, static_cast<double>(allocs) / iterations};
+         }
+         // Aim a little past minTime so the final run usually qualifies
+         double scale = elapsed > 0 ? 1.2 * minTime / elapsed : 100;
+         iterations = static_cast<unsigned long>(iterations * (scale > 100 ? 100 : scale < 2 ? 2 : scale));
+     }
+ }
+
+ std::vector<Benchmark> makeBenchmarks() {
+     std::vector<Benchmark> list;
+     Bikram bs;
+
+     // Table lookups at the start, middle and end of the hand-verified 2000-2099 BS rows
+     struct Point { const char* label; int adY, adM, adD, bsY, bsM, bsD; };
+     const Point table[] = {
+         {"table_start", 1943, 4, 20, 2000, 1, 7},
+         {"table_middle", 1993, 8, 15, 2050, 4, 30},
+         {"table_end", 2043, 3, 30, 2099, 12, 17},
+     };
+     for (const Point& p : table) {
+         list.push_back({std::string("fromGregorian/") + p.label, [bs, p]() mutable {
+             bs.fromGregorian(p.adY, p.adM, p.adD);
+             keep(bs);
+         }});
+         list.push_back({std::string("toGregorian/") + p.label, [bs, p]() mutable {
+             int y, m, d;
+             bs.toGregorian(p.bsY, p.bsM, p.bsD, y, m, d);
+             keep(y), keep(m), keep(d);
+         }});
+     }
+
+     // The stateless constexpr API on the same table dates, with inputs the compiler cannot fold
+     for (const Point& p : table) {
+         list.push_back({std::string("Bikram::toBs/") + p.label, [p]() mutable {
+             keep(p);
+             BsDate bs = Bikram::toBs({p.adY, p.adM, p.adD});
+             keep(bs);
+         }});
+         list.push_back({std::string("Bikram::toAd/") + p.label, [p]() mutable {
+             keep(p);
+             AdDate ad = Bikram::toAd({p.bsY, p.bsM, p.bsD});
+             keep(ad);
+         }});
+     }
+
+     // Astronomical fallbacks, called directly so the result does not depend on the table range
+     list.push_back({"fromGregorianAstronomical/1443AD", [bs]() mutable {
+         bs.fromGregorianAstronomical(1443, 7, 15);
+         keep(bs);
+     }});
+     list.push_back({"toGregorianAstronomical/1500BS", [bs]() mutable {
+         int y, m, d;
+         bs.toGregorianAstronomical(1500, 7, 15, y, m, d);
+         keep(y), keep(m), keep(d);
+     }});
+     // Walk 1000 years so every call misses the 256-year cache and runs the sankranti solver
+     list.push_back({"toGregorianAstronomical/uncached", [bs, year = 0]() mutable {
+         int y, m, d;
+         bs.toGregorianAstronomical(1000 + year, 7, 15, y, m, d);
+         year = (year + 1) % 1000;
+         keep(y), keep(m), keep(d);
+     }});
+     list.push_back({"fromGregorian/outside_table", [bs]() mutable {
+         bs.fromGregorian(1443, 7, 15);
+         keep(bs);
+     }});
+     list.push_back({"toGregorian/outside_table", [bs]() mutable {
+         int y, m, d;
+         bs.toGregorian(1500, 7, 15, y, m, d);
+         keep(y), keep(m), keep(d);
+     }});
+
+     list.push_back({"daysInMonth/table", [bs]() mutable {
+         int days = bs.daysInMonth(2082, 5);
+         keep(days);
+     }});
+     list.push_back({"daysInMonth/outside_table", [bs]() mutable {
+         int days = bs.daysInMonth(1500, 5);
+         keep(days);
+     }});
+
+     // Date arithmetic across a day and across several decades should cost the same
+     for (long days : {1L, 36524L}) {
+         list.push_back({"addDays/" + std::to_string(days), [bs, days]() mutable {
+             bs.addDays(2000, 1, 15, days);
+             keep(bs);
+         }});
+     }
+     list.push_back({"addMonths/1200", [bs]() mutable {
+         bs.addMonths(1950, 2, 32, 1200);
+         keep(bs);
+     }});
+     list.push_back({"monthsBetween/table", [bs]() mutable {
+         long months = bs.monthsBetween(2001, 2, 32, 2098, 3, 15);
+         keep(months);
+     }});
+
+     // Event lookups, walking a day at a time through 2000-2099 BS
+     const long walkStart = Bikram::toJulianDay(1943, 4, 14);
+     list.push_back({"Sankranti::next/table", [jdn = walkStart]() mutable {
+         if (++jdn == walkStart + 36524) jdn = walkStart;
+         SankrantiTime time = Sankranti::next(jdn);
+         keep(time);
+     }});
+     // A calendar of 26 holidays a year for the same century
+     static HolidayCalendar holidays;
+     std::string holidayText;
+     for (int year = 2000; year <= 2099; ++year) {
+         for (int month = 1; month <= 12; ++month) {
+             for (int day : {1, 15}) {
+                 if (month == 12 && day == 15) continue;
+                 holidayText += std::to_string(year) + "-" + std::to_string(month) + "-" + std::to_string(day) + " Holiday\n";
+             }
+         }
+         holidayText += std::to_string(year) + "-06-10.." + std::to_string(year) + "-06-12 Festival\n";
+     }
+     holidays.parse(holidayText.data(), holidayText.size());
+     list.push_back({"HolidayCalendar::isHoliday", [jdn = walkStart]() mutable {
+         if (++jdn == walkStart + 36524) jdn = walkStart;
+         bool holiday = holidays.isHoliday(jdn);
+         keep(holiday);
+     }});
+     list.push_back({"HolidayCalendar::range/month", [jdn = walkStart]() mutable {
+         if (++jdn == walkStart + 36524) jdn = walkStart;
+         std::size_t begin, end;
+         holidays.range(jdn, jdn + 30, begin, end);
+         keep(begin), keep(end);
+     }});
+
+     // One day of a range walk; restarts every 100 years so the table stays in range
+     list.push_back({"BikramDayIterator/advance", [it = BikramDayIterator(Bikram::toJulianDay(1943, 4, 14)), steps = 0]() mutable {
+         if (++steps == 36524) {
+             it = BikramDayIterator(Bikram::toJulianDay(1943, 4, 14));
+             steps = 0;
+         }
+         ++it;
+         keep(*it);
+     }});
+
+     list.push_back({"displayFormattedDate/bs", []() {
+         displayFormattedDate(2082, 5, 14, "y-m-d", false, false);
+     }});
+     list.push_back({"displayFormattedDate/bs_unicode", []() {
+         displayFormattedDate(2082, 5, 14, "d M, y, w", true, false);
+     }});
+     list.push_back({"displayFormattedDate/ad", []() {
+         displayFormattedDate(2025, 8, 30, "y-M-d, W", false, true);
+     }});
+     list.push_back({"displayStrfFormattedDateTime/bs_unicode", []() {
+         displayStrfFormattedDateTime(2082, 5, 14, 11, 26, 30, "%A, %d %B %Y, %I:%M:%S %p", true, false);
+     }});
+     list.push_back({"displayStrfFormattedDateTime/ad_c", []() {
+         displayStrfFormattedDateTime(2025, 8, 30, 11, 26, 30, "%c", false, true);
+     }});
+
+     // Rendering a precompiled format into a fixed buffer, as --batch and --csv do per line
+     static const CompiledFormat simple("d M, y, w", CompiledFormat::SIMPLE, true, false);
+     static const CompiledFormat strftime("%A, %d %B %Y, %I:%M:%S %p", CompiledFormat::STRFTIME, true, false);
+     list.push_back({"CompiledFormat::render/simple_unicode", []() {
+         char buf[256];
+         size_t n = simple.render(buf, sizeof buf, {2082, 5, 14, 6});
+         keep(buf), keep(n);
+     }});
+     list.push_back({"CompiledFormat::render/strftime_unicode", []() {
+         char buf[256];
+         size_t n = strftime.render(buf, sizeof buf, {2082, 5, 14, 6, 11, 26, 30});
+         keep(buf), keep(n);
+     }});
+
+     // Reading one input line, as --batch and --csv do before converting it
+     for (const char* text : {"2025-08-30", "2025/8/30", "२०८२-०५-१४"}) {
+         std::string_view line = text;
+         std::string name = line.size() == 10 ? "parseDateFields/iso" : line[0] == '2' ? "parseDateFields/slashed" : "parseDateFields/devanagari";
+         list.push_back({name, [line]() {
+             int y, m, d;
+             keep(line);
+             bool ok = parseDateFields(line.data(), line.data() + line.size(), y, m, d);
+             keep(ok), keep(y), keep(m), keep(d);
+         }});
+     }
+     return list;
+ }
+
+ // Run argv[0] `runs` times one after another, as a shell loop calling the CLI would
+ int runStartup(char* const* command, unsigned long runs) {
+     posix_spawn_file_actions_t actions;
+     posix_spawn_file_actions_init(&actions);
+     posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+     posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+     auto start = std::chrono::steady_clock::now();
+     for (unsigned long i = 0; i < runs; ++i) {
+         pid_t pid;
+         int status;
+         if (posix_spawn(&pid, command[0], &actions, nullptr, command, environ) != 0 || waitpid(pid, &status, 0) != pid) {
+             std::cerr << "Error: Cannot run " << command[0] << std::endl;
+             return 1;
+         }
+     }
+     double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+     posix_spawn_file_actions_destroy(&actions);
+     std::printf("{\"benchmarks\": [\n  {\"name\": \"startup\", \"iterations\": %lu, \"us_per_run\": %.1f}\n]}\n",
+                 runs, elapsed * 1e6 / runs);
+     return 0;
+ }
+
+ int main(int argc, char* argv[]) {
+     double minTime = 0.2;
+     std::string filter;
+     unsigned long runs = 10000;
+     for (int i = 1; i < argc; ++i) {
+         if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+             runs = std::strtoul(argv[++i], nullptr, 10);
+         } else if (std::strcmp(argv[i], "--startup") == 0 && i + 1 < argc) {
+             return runStartup(argv + i + 1, runs ? runs : 1);
+         } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+             minTime = std::atof(argv[++i]);
+         } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+             filter = argv[++i];
+         } else {
+             std::cerr << "Usage: " << argv[0] << " [--filter substring] [--min-time seconds]\n"
+                       << "       " << argv[0] << " [--runs N] --startup BINARY [ARGS...]" << std::endl;
+             return 1;
+         }
+     }
+
+     NullBuffer null;
+     std::streambuf* saved = std::cout.rdbuf(&null);
+     std::vector<Result> results;
+     for (const Benchmark& bench : makeBenchmarks()) {
+         if (filter.empty() || bench.name.find(filter) != std::string::npos) {
+             results.push_back(run(bench, minTime));
+         }
+     }
+     std::cout.rdbuf(saved);
+
+     std::printf("{\"benchmarks\": [\n");
+     for (size_t i = 0; i < results.size(); ++i) {
+         const Result& r = results[i];
+         std::printf("  {\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f}%s\n",
+                     r.name.c_str(), r.iterations, r.nsPerOp, r.allocsPerOp, i + 1 < results.size() ? "," : "");
+     }
+     std::printf("]}\n");
+     return 0;
+ }
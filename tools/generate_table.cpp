@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // Generates bikram_table.h: month lengths for a range of BS years.
+ //
+ // Built against bikram.h without BIKRAM_GENERATED_TABLE, so toGregorian answers from the
+ // hand-verified NP_MONTHS_DATA for 2000-2099 and from the astronomical engine elsewhere.
+ // Month lengths are taken as the distance between consecutive month starts, which keeps the
+ // hand-verified rows exact and makes the months next to them absorb any difference with the
+ // astronomical model, so the generated table has no gaps or overlaps.
+ //
+ // It also writes the sankranti index: the instant the sun enters each month's sign, as minutes
+ // from the model's midnight at the start of that month's first day, 12 per year in order.
+ #include "bikram.h"
+ #include <fstream>
+ #include <iostream>
+ #include <string>
+ #include <vector>
+
+ int main(int argc, char *argv[]) {
+     if (argc != 4) {
+         std::cerr << "Usage: " << argv[0] << " START_YEAR END_YEAR OUTPUT_HEADER" << std::endl;
+         return 1;
+     }
+
+     int startYear, endYear;
+     try {
+         startYear = std::stoi(argv[1]);
+         endYear = std::stoi(argv[2]);
+     } catch (const std::exception&) {
+         std::cerr << "Error: Invalid year range." << std::endl;
+         return 1;
+     }
+     if (startYear < 1 || endYear < startYear || endYear > 9999) {
+         std::cerr << "Error: Invalid year range " << startYear << "-" << endYear << "." << std::endl;
+         return 1;
+     }
+
+     // First day (JDN) of every month in the range, plus 1 Baisakh of the following year
+     Bikram bs;
+     std::vector<long> monthStarts;
+     for (int year = startYear; year <= endYear + 1; ++year) {
+         for (int month = 1; month <= 12; ++month) {
+             int gy, gm, gd;
+             bs.toGregorian(year, month, 1, gy, gm, gd);
+             monthStarts.push_back(Bikram::toJulianDay(gy, gm, gd));
+             if (year > endYear) break;
+         }
+     }
+
+     std::ofstream out(argv[3]);
+     if (!out) {
+         std::cerr << "Error: Cannot write " << argv[3] << std::endl;
+         return 1;
+     }
+
+     out << "// Generated by bikram-table-gen for " << startYear << "-" << endYear << " BS. Do not edit.\n"
+         << "#ifndef BIKRAM_TABLE_H\n"
+         << "#define BIKRAM_TABLE_H\n\n"
+         << "#define BIKRAM_TABLE_START_YEAR " << startYear << "\n"
+         << "#define BIKRAM_TABLE_START_JDN " << monthStarts[0] << "L\n\n"
+         << "inline constexpr int BIKRAM_TABLE_DATA[][13] = {\n";
+     for (int year = startYear; year <= endYear; ++year) {
+         size_t first = static_cast<size_t>(year - startYear) * 12;
+         out << "    {";
+         for (int month = 0; month < 12; ++month) {
+             long length = monthStarts[first + month + 1] - monthStarts[first + month];
+             if (length < 29 || length > 32) {
+                 std::cerr << "Error: " << year << "-" << month + 1 << " has " << length << " days." << std::endl;
+                 return 1;
+             }
+             out << length << ",";
+         }
+         out << monthStarts[first + 12] - monthStarts[first] << "}, // " << year << "\n";
+     }
+     out << "};\n\n"
+         << "inline constexpr int BIKRAM_SANKRANTI_DATA[] = {\n";
+     for (int year = startYear; year <= endYear; ++year) {
+         // Relative to each month rather than the table start, so entries fit an int for any range
+         size_t first = static_cast<size_t>(year - startYear) * 12;
+         out << "    ";
+         for (int month = 1; month <= 12; ++month) {
+             int minute;
+             long day = Bikram::sankranti(year, month, minute);
+             out << (day - monthStarts[first + month - 1]) * 1440 + minute << ",";
+         }
+         out << " // " << year << "\n";
+     }
+     out << "};\n\n#endif // BIKRAM_TABLE_H\n";
+
+     return out ? 0 : 1;
+ }
@@ -0,0 +1,492 @@
+/*
+ * Copyright (C) 2024 khumnath cg <mail@khumnath.com.np>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+ // nepdate-validate: exhaustive cross-check of the conversion engine.
+ //
+ // Every day of the range (by default every day whose AD and BS years are both in 1-9999,
+ // the range libbikram accepts) is checked on all cores:
+ //   round trip   fromGregorian then toGregorian returns the same day, with the BS day
+ //                inside 1..daysInMonth, and bsToJulianDay (used by date arithmetic) agrees
+ //   iterator     BikramDayIterator walking the range agrees with fromGregorian
+ //   weekday      getWeekday and the iterator agree with a count of days from a known Saturday,
+ //                also over AD years <= 0 (from JDN 0, AD -4712) before the range starts
+ //   julian day   over the same days, toJulianDay agrees with the floating-point getJulianDate
+ //                it replaced, and fromJulianDay with the old fromJulianDate where that was
+ //                right (1900-03-01 to 2100-02-28; its fixed century term breaks outside)
+ //   month length on the first day of every month, daysInMonth is 29-32 and toGregorian
+ //                of the next month's first day is exactly that many days later
+ //   sankranti    on the first day of every month, Sankranti::of keeps the sankranti on that
+ //                day, and its modelDay points at the day the astronomical model starts the month
+ //   tslong       on every day, the libm and the polynomial (BIKRAM_DETERMINISTIC_TSLONG) solar
+ //                longitudes agree on the sign the sun is in and on whether a saura masa starts
+ //   simd         on every day, getTslongBatch agrees with the scalar longitude on the sign and
+ //                on whether a saura masa starts, and the SSE2 and AVX2 kernels stay within
+ //                TSLONG_BATCH_EPSILON of it, so the boundary recompute catches every difference
+ //   records      --output jsonl, csv and binary records read back as the dates they were made
+ //                from, for every day of BS 1 through AD 1 (AD years <= 0 included) and the last
+ //                BS year; binary gives the all-zero record for AD years below 0
+ //   table        inside the month table, fromGregorian is compared with
+ //                fromGregorianAstronomical and differing month starts are listed
+ //
+ // The constexpr API (Bikram::toBs, toAd, daysInBsMonth) is checked at compile time below.
+ //
+ // The first nine are invariants: any mismatch makes the exit status 1. Table/astronomical
+ // differences are expected where the hand-verified data corrects the model, so they are
+ // reported for comparison between runs rather than treated as failures.
+ #include "bikram.h"
+ #include "bikram_events.h"
+ #include "dateformat.h"
+ #include "recordwriter.h"
+ #include <algorithm>
+ #include <atomic>
+ #include <chrono>
+ #include <cmath>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <mutex>
+ #include <string>
+ #include <thread>
+ #include <vector>
+
+ // Compile-time checks: the constexpr conversions must agree with known dates and round-trip
+ // every day of the hand-verified 2000-2099 BS rows, which every table configuration contains.
+ static_assert(Bikram::toAd({2000, 1, 1}) == AdDate{1943, 4, 14}, "BS epoch");
+ static_assert(Bikram::toBs({2025, 8, 30}) == BsDate{2082, 5, 14}, "AD to BS");
+ static_assert(Bikram::toAd({2082, 4, 1}) == AdDate{2025, 7, 17}, "BS to AD");
+ static_assert(Bikram::toBs({2043, 4, 13}) == BsDate{2099, 12, 30}, "last day of the verified rows");
+ static_assert(Bikram::daysInBsMonth(2082, 5) == 31 && Bikram::daysInBsMonth(2081, 2) == 32, "month lengths");
+
+ constexpr bool verifiedRowsRoundTrip() {
+     for (int year = 2000; year <= 2099; ++year) {
+         for (int month = 1; month <= 12; ++month) {
+             for (int day = 1; day <= Bikram::daysInBsMonth(year, month); ++day) {
+                 BsDate bs{year, month, day};
+                 if (Bikram::toBs(Bikram::toAd(bs)) != bs) return false;
+             }
+         }
+     }
+     return true;
+ }
+ static_assert(verifiedRowsRoundTrip(), "2000-2099 BS round trip");
+
+ struct Totals {
+     long days = 0;
+     long roundTrip = 0;
+     long iterator = 0;
+     long weekdayDays = 0;
+     long weekday = 0;
+     long julianDay = 0;
+     long months = 0;
+     long monthLength = 0;
+     long sankranti = 0;
+     long tslong = 0;
+     double tslongMaxDiff = 0;
+     long simd = 0;
+     double simdMaxDiff = 0;
+     long records = 0;
+     long recordsWrong = 0;
+     long tableDays = 0;
+     long tableDiffDays = 0;
+     long tableDiffMonths = 0;
+ };
+
+ // Examples of each kind of mismatch, kept in range order
+ struct Example {
+     long jdn;
+     std::string text;
+ };
+
+ long bsToJdn(Bikram& bs, int year, int month, int day) {
+     int gy, gm, gd;
+     bs.toGregorian(year, month, day, gy, gm, gd);
+     return Bikram::toJulianDay(gy, gm, gd);
+ }
+
+ template <typename... Args>
+ std::string describe(const char* format, Args... args) {
+     char text[160];
+     std::snprintf(text, sizeof text, format, args...);
+     return text;
+ }
+
+ // 2025-08-30 was a Saturday
+ const long SATURDAY_JDN = Bikram::toJulianDay(2025, 8, 30);
+
+ int expectedWeekday(long jdn) {
+     long offset = (jdn - SATURDAY_JDN + 6) % 7;
+     return static_cast<int>(offset < 0 ? offset + 7 : offset);
+ }
+
+ // The floating-point Julian date conversions Bikram used before toJulianDay/fromJulianDay
+ double legacyJulianDate(int year, int month, int day) {
+     if (month <= 2) {
+         year -= 1;
+         month += 12;
+     }
+     double a = std::floor(year / 100.0);
+     double b = 2 - a + std::floor(a / 4.0);
+     return std::floor(365.25 * (year + 4716)) + std::floor(30.6001 * (month + 1)) + day + b - 1524.5;
+ }
+
+ void legacyFromJulianDate(double julianDate, int& year, int& month, int& day) {
+     int a = static_cast<int>(julianDate + 0.5);
+     int b = a + 1537;
+     int c = static_cast<int>((b - 122.1) / 365.25);
+     int d = static_cast<int>(365.25 * c);
+     int e = static_cast<int>((b - d) / 30.6001);
+     double f = b - d - static_cast<int>(30.6001 * e) + (julianDate + 0.5 - a);
+     day = static_cast<int>(f);
+     month = (e < 14) ? (e - 1) : (e - 13);
+     year = (month > 2) ? (c - 4716) : (c - 4715);
+ }
+
+ const long LEGACY_FIRST_JDN = Bikram::toJulianDay(1900, 3, 1);
+ const long LEGACY_LAST_JDN = Bikram::toJulianDay(2100, 2, 28);
+
+ // Check the day jdn, which fromJulianDay gave as AD gy-gm-gd, against the legacy conversions
+ void checkJulianDay(long jdn, int gy, int gm, int gd, Totals& totals, std::vector<Example>& invariant) {
+     double legacy = legacyJulianDate(gy, gm, gd);
+     int ly = gy, lm = gm, ld = gd;
+     if (jdn >= LEGACY_FIRST_JDN && jdn <= LEGACY_LAST_JDN) legacyFromJulianDate(jdn - 0.5, ly, lm, ld);
+     if (Bikram::toJulianDay(gy, gm, gd) != jdn || legacy != jdn - 0.5 || ly != gy || lm != gm || ld != gd) {
+         ++totals.julianDay;
+         invariant.push_back({jdn, describe("julian day: JDN %ld is AD %d-%02d-%02d, getJulianDate gives %.1f, fromJulianDate %d-%02d-%02d",
+                                           jdn, gy, gm, gd, legacy, ly, lm, ld)});
+     }
+ }
+
+ // Check getWeekday and the Julian day conversions on the days [first, last], for the stretch
+ // before the main range
+ void checkEarlyDays(long first, long last, Totals& totals, std::vector<Example>& invariant) {
+     for (long jdn = first; jdn <= last; ++jdn) {
+         ++totals.weekdayDays;
+         int gy, gm, gd;
+         Bikram::fromJulianDay(jdn, gy, gm, gd);
+         int weekday = getWeekday(gy, gm, gd);
+         if (weekday != expectedWeekday(jdn)) {
+             ++totals.weekday;
+             invariant.push_back({jdn, describe("weekday: AD %d-%02d-%02d is weekday %d, getWeekday gives %d",
+                                               gy, gm, gd, expectedWeekday(jdn), weekday)});
+         }
+         checkJulianDay(jdn, gy, gm, gd, totals, invariant);
+     }
+ }
+
+ // Longitude getTslong uses in this build
+ double scalarTslong(long ahar) {
+ #ifdef BIKRAM_DETERMINISTIC_TSLONG
+     return Bikram::tslongPolynomial(ahar);
+ #else
+     return Bikram::tslongLibm(ahar);
+ #endif
+ }
+
+ // Check getTslongBatch and the SIMD kernels against scalarTslong on the days [first, last]
+ void checkTslongBatch(long first, long last, Totals& totals, std::vector<Example>& invariant) {
+     const long chunk = 256;
+     long ahar[chunk + 1] = {};
+     double scalar[chunk + 1] = {}, batch[chunk + 1] = {};
+     for (long from = first; from <= last; from += chunk) {
+         long count = std::min(chunk, last - from + 1);
+         // One more day than is checked, for the end of the last day
+         for (long i = 0; i <= count; ++i) {
+             ahar[i] = from + i - Bikram::AHAR_JDN_OFFSET;
+             scalar[i] = scalarTslong(ahar[i]);
+         }
+         Bikram::getTslongBatch(ahar, batch, count + 1);
+         for (long i = 0; i < count; ++i) {
+             if (static_cast<int>(batch[i] / 30) != static_cast<int>(scalar[i] / 30) ||
+                 Bikram::isSauraMasaFirst(batch[i], batch[i + 1]) != Bikram::isSauraMasaFirst(scalar[i], scalar[i + 1])) {
+                 ++totals.simd;
+                 invariant.push_back({from + i, describe("simd: JDN %ld starts at %.12f degrees in getTslongBatch, %.12f in getTslong",
+                                                        from + i, batch[i], scalar[i])});
+             }
+         }
+ #ifdef BIKRAM_HAVE_X86_SIMD
+         double kernel[chunk + 1] = {};
+         for (int avx2 = 0; avx2 <= bikram_simd::hasAvx2(); ++avx2) {
+             if (avx2) bikram_simd::tslongAvx2(ahar, kernel, count, Bikram::TSLONG_PARAMS);
+             else bikram_simd::tslongSse2(ahar, kernel, count, Bikram::TSLONG_PARAMS);
+             for (long i = 0; i < count; ++i) {
+                 double diff = std::fabs(kernel[i] - scalar[i]);
+                 totals.simdMaxDiff = std::max(totals.simdMaxDiff, diff);
+                 if (diff >= TSLONG_BATCH_EPSILON) {
+                     ++totals.simd;
+                     invariant.push_back({from + i, describe("simd: JDN %ld is %.12f degrees in the %s kernel, %.12f in getTslong",
+                                                            from + i, kernel[i], avx2 ? "AVX2" : "SSE2", scalar[i])});
+                 }
+             }
+         }
+ #endif
+     }
+ }
+
+ // Check the days [first, last] and add the results to totals and examples
+ void checkBlock(long first, long last, Totals& totals, std::vector<Example>& invariant, std::vector<Example>& table) {
+     Bikram bs, astro;
+     BikramDayIterator it(first);
+     double libm = Bikram::tslongLibm(first - Bikram::AHAR_JDN_OFFSET);
+     double polynomial = Bikram::tslongPolynomial(first - Bikram::AHAR_JDN_OFFSET);
+     int expected = expectedWeekday(first);
+     for (long jdn = first; jdn <= last; ++jdn, ++it, expected = (expected + 1) % 7) {
+         ++totals.days;
+         int gy, gm, gd;
+         Bikram::fromJulianDay(jdn, gy, gm, gd);
+         bs.fromGregorian(gy, gm, gd);
+         int y = bs.getYear(), m = bs.getMonth(), d = bs.getDay();
+
+         int length = bs.daysInMonth(y, m);
+         int ry, rm, rd;
+         bs.toGregorian(y, m, d, ry, rm, rd);
+         if (d < 1 || d > length || ry != gy || rm != gm || rd != gd || bs.bsToJulianDay(y, m, d) != jdn) {
+             ++totals.roundTrip;
+             invariant.push_back({jdn, describe("round trip: AD %d-%02d-%02d -> BS %d-%02d-%02d -> AD %d-%02d-%02d",
+                                               gy, gm, gd, y, m, d, ry, rm, rd)});
+         }
+         if (it->bsYear != y || it->bsMonth != m || it->bsDay != d || it->adYear != gy || it->adMonth != gm || it->adDay != gd) {
+             ++totals.iterator;
+             invariant.push_back({jdn, describe("iterator: AD %d-%02d-%02d is BS %d-%02d-%02d, iterator has BS %d-%02d-%02d",
+                                               gy, gm, gd, y, m, d, it->bsYear, it->bsMonth, it->bsDay)});
+         }
+         ++totals.weekdayDays;
+         int weekday = getWeekday(gy, gm, gd);
+         if (weekday != expected || it->weekday != expected) {
+             ++totals.weekday;
+             invariant.push_back({jdn, describe("weekday: AD %d-%02d-%02d is weekday %d, getWeekday gives %d, the iterator %d",
+                                               gy, gm, gd, expected, weekday, it->weekday)});
+         }
+         checkJulianDay(jdn, gy, gm, gd, totals, invariant);
+         double nextLibm = Bikram::tslongLibm(jdn + 1 - Bikram::AHAR_JDN_OFFSET);
+         double nextPolynomial = Bikram::tslongPolynomial(jdn + 1 - Bikram::AHAR_JDN_OFFSET);
+         if (static_cast<int>(libm / 30) != static_cast<int>(polynomial / 30) ||
+             Bikram::isSauraMasaFirst(libm, nextLibm) != Bikram::isSauraMasaFirst(polynomial, nextPolynomial)) {
+             ++totals.tslong;
+             invariant.push_back({jdn, describe("tslong: AD %d-%02d-%02d starts at %.12f degrees with libm, %.12f with polynomials",
+                                               gy, gm, gd, libm, polynomial)});
+         }
+         totals.tslongMaxDiff = std::max(totals.tslongMaxDiff, std::fabs(libm - polynomial));
+         libm = nextLibm;
+         polynomial = nextPolynomial;
+
+         if (d == 1) {
+             ++totals.months;
+             int nextYear = m == 12 ? y + 1 : y;
+             int nextMonth = m % 12 + 1;
+             long next = bsToJdn(bs, nextYear, nextMonth, 1);
+             if (length < 29 || length > 32 || next != jdn + length) {
+                 ++totals.monthLength;
+                 invariant.push_back({jdn, describe("month length: BS %d-%02d has %d days but the next month starts %ld days later",
+                                                   y, m, length, next - jdn)});
+             }
+             int ay, am, ad;
+             astro.toGregorianAstronomical(y, m, 1, ay, am, ad);
+             SankrantiTime time = Sankranti::of(y, m);
+             if (time.jdn != jdn || time.jdn + time.modelDay != Bikram::toJulianDay(ay, am, ad) ||
+                 time.minute < 0 || time.minute >= 1440) {
+                 ++totals.sankranti;
+                 invariant.push_back({jdn, describe("sankranti: BS %d-%02d begins AD %d-%02d-%02d astronomically, its sankranti is on JDN %ld%+d",
+                                                   y, m, ay, am, ad, time.jdn, time.modelDay)});
+             }
+         }
+
+         if (y >= Bikram::getTableStartYear() && y <= Bikram::getTableEndYear()) {
+             ++totals.tableDays;
+             astro.fromGregorianAstronomical(gy, gm, gd);
+             if (astro.getYear() != y || astro.getMonth() != m || astro.getDay() != d) ++totals.tableDiffDays;
+             if (d == 1) {
+                 int ay, am, ad;
+                 astro.toGregorianAstronomical(y, m, 1, ay, am, ad);
+                 if (ay != gy || am != gm || ad != gd) {
+                     ++totals.tableDiffMonths;
+                     table.push_back({jdn, describe("BS %d-%02d starts AD %d-%02d-%02d in the table, %d-%02d-%02d astronomically",
+                                                   y, m, gy, gm, gd, ay, am, ad)});
+                 }
+             }
+         }
+     }
+     checkTslongBatch(first, last, totals, invariant);
+ }
+
+ // Write the days [first, last] as records of each mode and read them back
+ void checkRecords(long first, long last, Totals& totals, std::vector<Example>& invariant) {
+     const RecordWriter::Mode modes[] = {RecordWriter::JSONL, RecordWriter::CSV, RecordWriter::BINARY};
+     const char* names[] = {"jsonl", "csv", "binary"};
+     for (int mode = 0; mode < 3; ++mode) {
+         std::FILE* file = std::tmpfile();
+         if (!file) {
+             ++totals.recordsWrong;
+             invariant.push_back({first, describe("records: cannot create a temporary file")});
+             return;
+         }
+         {
+             RecordWriter writer(modes[mode], fileno(file));
+             BikramDayIterator it(first);
+             for (long jdn = first; jdn <= last; ++jdn, ++it) {
+                 writer.add(*it, it.bsMonthDays());
+             }
+         }
+         std::rewind(file);
+         char line[128];
+         if (modes[mode] == RecordWriter::CSV && !std::fgets(line, sizeof line, file)) line[0] = 0; // header
+         BikramDayIterator it(first);
+         for (long jdn = first; jdn <= last; ++jdn, ++it) {
+             ++totals.records;
+             int r[8] = {};
+             bool ok;
+             if (modes[mode] == RecordWriter::BINARY) {
+                 unsigned char b[RecordWriter::BINARY_RECORD_SIZE] = {};
+                 ok = std::fread(b, 1, sizeof b, file) == sizeof b;
+                 int values[8] = {b[0] | b[1] << 8, b[2], b[3], b[4] | b[5] << 8, b[6], b[7], b[8], b[9]};
+                 std::copy(values, values + 8, r);
+                 if (it->adYear < 0) ok = ok && std::count(b, b + sizeof b, 0) == static_cast<long>(sizeof b);
+             } else {
+                 const char* layout = modes[mode] == RecordWriter::JSONL
+                     ? "{\"bs\":\"%d-%d-%d\",\"ad\":\"%d-%d-%d\",\"weekday\":%d,\"bs_days_in_month\":%d}"
+                     : "%d-%d-%d,%d-%d-%d,%d,%d";
+                 ok = std::fgets(line, sizeof line, file) &&
+                      std::sscanf(line, layout, &r[0], &r[1], &r[2], &r[3], &r[4], &r[5], &r[6], &r[7]) == 8;
+             }
+             if (modes[mode] != RecordWriter::BINARY || it->adYear >= 0) {
+                 ok = ok && r[0] == it->bsYear && r[1] == it->bsMonth && r[2] == it->bsDay && r[3] == it->adYear &&
+                      r[4] == it->adMonth && r[5] == it->adDay && r[6] == it->weekday && r[7] == it.bsMonthDays();
+             }
+             if (!ok) {
+                 ++totals.recordsWrong;
+                 invariant.push_back({jdn, describe("records: %s record of AD %d-%02d-%02d reads back as BS %d-%02d-%02d AD %d-%02d-%02d",
+                                                   names[mode], it->adYear, it->adMonth, it->adDay, r[0], r[1], r[2], r[3], r[4], r[5])});
+             }
+         }
+         std::fclose(file);
+     }
+ }
+
+ // Kernels checkTslongBatch compared on this machine
+ const char* simdKernels() {
+ #ifdef BIKRAM_HAVE_X86_SIMD
+     return bikram_simd::hasAvx2() ? ", SSE2 and AVX2" : ", SSE2 only";
+ #else
+     return ", no SIMD kernels in this build";
+ #endif
+ }
+
+ void printExamples(std::vector<Example>& examples, size_t limit) {
+     std::sort(examples.begin(), examples.end(), [](const Example& a, const Example& b) { return a.jdn < b.jdn; });
+     for (size_t i = 0; i < examples.size() && i < limit; ++i) {
+         std::printf("    %s\n", examples[i].text.c_str());
+     }
+     if (examples.size() > limit) std::printf("    ... %zu more\n", examples.size() - limit);
+ }
+
+ int main(int argc, char* argv[]) {
+     unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+     int startYear = 0, endYear = 0;
+     size_t show = 10;
+     for (int i = 1; i < argc; ++i) {
+         if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+             threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+         } else if (std::strcmp(argv[i], "--years") == 0 && i + 2 < argc) {
+             startYear = std::atoi(argv[++i]);
+             endYear = std::atoi(argv[++i]);
+         } else if (std::strcmp(argv[i], "--show") == 0 && i + 1 < argc) {
+             show = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+         } else {
+             std::fprintf(stderr, "Usage: %s [--years BS_START BS_END] [--threads N] [--show N]\n", argv[0]);
+             return 1;
+         }
+     }
+
+     Bikram bs;
+     long first = Bikram::toJulianDay(1, 1, 1);
+     long last = bsToJdn(bs, 10000, 1, 1) - 1;
+     if (startYear != 0 || endYear != 0) {
+         if (startYear < 1 || endYear < startYear || endYear > 9999) {
+             std::fprintf(stderr, "Error: Invalid BS year range %d-%d.\n", startYear, endYear);
+             return 1;
+         }
+         first = std::max(first, bsToJdn(bs, startYear, 1, 1));
+         last = std::min(last, bsToJdn(bs, endYear + 1, 1, 1) - 1);
+     }
+
+     // Threads take fixed-size blocks in turn, so slow (astronomical) stretches balance out
+     const long blockDays = 1 << 15;
+     std::atomic<long> nextBlock{first};
+     std::mutex mutex;
+     Totals totals;
+     std::vector<Example> invariant, table;
+
+     auto start = std::chrono::steady_clock::now();
+     checkEarlyDays(0, first - 1, totals, invariant);
+     checkRecords(bsToJdn(bs, 1, 1, 1), Bikram::toJulianDay(1, 12, 31), totals, invariant);
+     checkRecords(bsToJdn(bs, 9999, 1, 1), bsToJdn(bs, 10000, 1, 1) - 1, totals, invariant);
+     std::vector<std::thread> pool;
+     for (unsigned t = 0; t < threads; ++t) {
+         pool.emplace_back([&] {
+             Totals local;
+             std::vector<Example> localInvariant, localTable;
+             for (long block; (block = nextBlock.fetch_add(blockDays)) <= last; ) {
+                 checkBlock(block, std::min(last, block + blockDays - 1), local, localInvariant, localTable);
+             }
+             std::lock_guard<std::mutex> lock(mutex);
+             totals.days += local.days;
+             totals.roundTrip += local.roundTrip;
+             totals.iterator += local.iterator;
+             totals.weekdayDays += local.weekdayDays;
+             totals.weekday += local.weekday;
+             totals.julianDay += local.julianDay;
+             totals.months += local.months;
+             totals.monthLength += local.monthLength;
+             totals.sankranti += local.sankranti;
+             totals.tslong += local.tslong;
+             totals.tslongMaxDiff = std::max(totals.tslongMaxDiff, local.tslongMaxDiff);
+             totals.simd += local.simd;
+             totals.simdMaxDiff = std::max(totals.simdMaxDiff, local.simdMaxDiff);
+             totals.tableDays += local.tableDays;
+             totals.tableDiffDays += local.tableDiffDays;
+             totals.tableDiffMonths += local.tableDiffMonths;
+             invariant.insert(invariant.end(), localInvariant.begin(), localInvariant.end());
+             table.insert(table.end(), localTable.begin(), localTable.end());
+         });
+     }
+     for (auto& t : pool) {
+         t.join();
+     }
+     double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+     int fy, fm, fd, ly, lm, ld;
+     Bikram::fromJulianDay(first, fy, fm, fd);
+     Bikram::fromJulianDay(last, ly, lm, ld);
+     std::printf("Checked AD %04d-%02d-%02d to %04d-%02d-%02d on %u thread%s\n", fy, fm, fd, ly, lm, ld, threads, threads == 1 ? "" : "s");
+     std::printf("  round trip    %ld of %ld days wrong\n", totals.roundTrip, totals.days);
+     std::printf("  iterator      %ld of %ld days wrong\n", totals.iterator, totals.days);
+     std::printf("  weekday       %ld of %ld days wrong\n", totals.weekday, totals.weekdayDays);
+     std::printf("  julian day    %ld of %ld days wrong\n", totals.julianDay, totals.weekdayDays);
+     std::printf("  month length  %ld of %ld months wrong\n", totals.monthLength, totals.months);
+     std::printf("  sankranti     %ld of %ld months wrong\n", totals.sankranti, totals.months);
+     std::printf("  tslong        %ld of %ld days differ between libm and polynomials (max %.1e degrees apart)\n",
+                 totals.tslong, totals.days, totals.tslongMaxDiff);
+     std::printf("  simd          %ld of %ld days differ from scalar getTslong (kernels at most %.1e degrees apart%s)\n",
+                 totals.simd, totals.days, totals.simdMaxDiff, simdKernels());
+     printExamples(invariant, show);
+     std::printf("  records       %ld of %ld records wrong\n", totals.recordsWrong, totals.records);
+     std::printf("  table         BS %d-%d: %ld of %ld days and %ld month starts differ from the astronomical model\n",
+                 Bikram::getTableStartYear(), Bikram::getTableEndYear(), totals.tableDiffDays, totals.tableDays, totals.tableDiffMonths);
+     printExamples(table, show);
+     std::printf("%.2f s, %.1fM days/s\n", seconds, totals.days / seconds / 1e6);
+
+     return invariant.empty() ? 0 : 1;
+ }